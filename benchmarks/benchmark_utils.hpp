@@ -0,0 +1,60 @@
+#pragma once
+
+#include "headless_render_context.hpp"
+#include "mock_effect_player.hpp"
+
+#include <interfaces/offscreen_render_target.hpp>
+#include <interfaces/pixel_buffer.hpp>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace bnb::oep::benchmarks
+{
+
+    /* frame sizes of the benchmarks, {width, height} */
+    inline const std::vector<std::vector<int64_t>> frame_sizes{{1280, 720}, {1920, 1080}, {3840, 2160}};
+
+    /* all the formats of interfaces::image_format, passed to the benchmarks as the argument */
+    inline const std::vector<int64_t> all_image_formats{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+    /* create the RGBA image with the gradient, the content does not affect the results but is not uniform */
+    inline pixel_buffer_sptr make_rgba_image(int32_t width, int32_t height)
+    {
+        using ns = bnb::oep::interfaces::pixel_buffer;
+        auto stride = width * 4;
+        auto data = std::shared_ptr<uint8_t>(new uint8_t[static_cast<size_t>(stride) * height], std::default_delete<uint8_t[]>());
+        for (int32_t y = 0; y < height; ++y) {
+            auto* row = data.get() + static_cast<size_t>(stride) * y;
+            for (int32_t x = 0; x < width; ++x) {
+                row[x * 4 + 0] = static_cast<uint8_t>(x);
+                row[x * 4 + 1] = static_cast<uint8_t>(y);
+                row[x * 4 + 2] = static_cast<uint8_t>(x + y);
+                row[x * 4 + 3] = 255;
+            }
+        }
+        std::vector<ns::plane_data> planes{{data, static_cast<size_t>(stride) * height, stride}};
+        return ns::create(planes, bnb::oep::interfaces::image_format::bpc8_rgba, width, height);
+    }
+
+    /* offscreen render target with the headless context, initialized and active on the calling thread */
+    inline offscreen_render_target_sptr make_active_render_target(int32_t width, int32_t height)
+    {
+        auto ort = bnb::oep::interfaces::offscreen_render_target::create(std::make_shared<headless_render_context>());
+        ort->init(width, height);
+        ort->activate_context();
+        return ort;
+    }
+
+    /* render the frame into the current buffer of the render target, the same way as the offscreen effect player does */
+    inline void render_frame(const offscreen_render_target_sptr& ort, mock_effect_player& ep, const pixel_buffer_sptr& image, bnb::oep::interfaces::rotation orient)
+    {
+        ort->prepare_rendering();
+        ep.push_frame(image, bnb::oep::interfaces::rotation::deg0, false);
+        ep.draw();
+        ort->orient_image(orient);
+    }
+
+} /* namespace bnb::oep::benchmarks */
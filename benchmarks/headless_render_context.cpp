@@ -0,0 +1,112 @@
+#include "headless_render_context.hpp"
+
+#include <opengl/opengl.hpp>
+#include <EGL/eglext.h>
+#include <stdexcept>
+#include <string>
+
+namespace bnb::oep::benchmarks
+{
+
+    /* headless_render_context::~headless_render_context */
+    headless_render_context::~headless_render_context()
+    {
+        delete_context();
+    }
+
+    /* headless_render_context::create_context */
+    void headless_render_context::create_context()
+    {
+        if (m_context != EGL_NO_CONTEXT) {
+            return;
+        }
+
+        /* the surfaceless platform does not need any display server */
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display != nullptr) {
+            m_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (m_display == EGL_NO_DISPLAY) {
+            m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        if (m_display == EGL_NO_DISPLAY || eglInitialize(m_display, nullptr, nullptr) != EGL_TRUE) {
+            throw std::runtime_error("[ERROR] Failed to initialize EGL display.");
+        }
+        if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+            throw std::runtime_error("[ERROR] OpenGL API is not supported by EGL.");
+        }
+
+        const EGLint config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_NONE};
+        EGLConfig config{nullptr};
+        EGLint config_count{0};
+        if (eglChooseConfig(m_display, config_attribs, &config, 1, &config_count) != EGL_TRUE || config_count == 0) {
+            throw std::runtime_error("[ERROR] Failed to choose EGL config.");
+        }
+
+        /* the offscreen render target renders into its own framebuffers, so the surface is minimal */
+        const EGLint surface_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        m_surface = eglCreatePbufferSurface(m_display, config, surface_attribs);
+
+        const EGLint context_attribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE};
+        m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, context_attribs);
+        if (m_context == EGL_NO_CONTEXT) {
+            throw std::runtime_error("[ERROR] Failed to create OpenGL 3.3 core context, EGL error " + std::to_string(eglGetError()));
+        }
+
+        activate();
+#if !defined(__ANDROID__)
+        if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)) == 0) {
+            throw std::runtime_error("[ERROR] Failed to load OpenGL functions.");
+        }
+#endif /* !defined(__ANDROID__) */
+    }
+
+    /* headless_render_context::activate */
+    void headless_render_context::activate()
+    {
+        eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+    }
+
+    /* headless_render_context::deactivate */
+    void headless_render_context::deactivate()
+    {
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+    /* headless_render_context::delete_context */
+    void headless_render_context::delete_context()
+    {
+        if (m_display == EGL_NO_DISPLAY) {
+            return;
+        }
+        deactivate();
+        if (m_context != EGL_NO_CONTEXT) {
+            eglDestroyContext(m_display, m_context);
+            m_context = EGL_NO_CONTEXT;
+        }
+        if (m_surface != EGL_NO_SURFACE) {
+            eglDestroySurface(m_display, m_surface);
+            m_surface = EGL_NO_SURFACE;
+        }
+        eglTerminate(m_display);
+        m_display = EGL_NO_DISPLAY;
+    }
+
+    /* headless_render_context::get_sharing_context */
+    void* headless_render_context::get_sharing_context()
+    {
+        return m_context;
+    }
+
+} /* namespace bnb::oep::benchmarks */
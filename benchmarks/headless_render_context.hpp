@@ -0,0 +1,34 @@
+#pragma once
+
+#include <interfaces/render_context.hpp>
+#include <EGL/egl.h>
+
+namespace bnb::oep::benchmarks
+{
+
+    /* Rendering context without a window based on EGL. With Mesa it may be used with the software rasterizer,
+     * e.g. LIBGL_ALWAYS_SOFTWARE=1, so the benchmarks run on the machines without a GPU */
+    class headless_render_context : public bnb::oep::interfaces::render_context
+    {
+    public:
+        headless_render_context() = default;
+
+        ~headless_render_context();
+
+        void create_context() override;
+
+        void activate() override;
+
+        void deactivate() override;
+
+        void delete_context() override;
+
+        void* get_sharing_context() override;
+
+    private:
+        EGLDisplay m_display{EGL_NO_DISPLAY};
+        EGLSurface m_surface{EGL_NO_SURFACE};
+        EGLContext m_context{EGL_NO_CONTEXT};
+    }; /* class headless_render_context */
+
+} /* namespace bnb::oep::benchmarks */
@@ -0,0 +1,261 @@
+#include "mock_effect_player.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+
+    /* full screen triangle without any vertex buffer */
+    const char* mock_vertex_shader =
+        "out vec2 vTexCoord;\n"
+        "void main() {\n"
+        "  vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+        "  vTexCoord = pos;\n"
+        "  gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n";
+
+    const char* mock_fragment_shader =
+        "precision highp float;\n"
+        "in vec2 vTexCoord;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D uTexture;\n"
+        "uniform sampler2D uTextureU;\n"
+        "uniform sampler2D uTextureV;\n"
+        "uniform int uInputFormat;\n"
+        "uniform int uIterations;\n"
+        "vec4 read_input(vec2 uv) {\n"
+        "  if (uInputFormat == 0) {\n"
+        "    return texture(uTexture, uv);\n"
+        "  }\n"
+        "  float y = texture(uTexture, uv).r;\n"
+        "  vec2 c = uInputFormat == 1 ? texture(uTextureU, uv).rg : vec2(texture(uTextureU, uv).r, texture(uTextureV, uv).r);\n"
+        "  c -= 0.5;\n"
+        "  return vec4(y + 1.402 * c.y, y - 0.344 * c.x - 0.714 * c.y, y + 1.772 * c.x, 1.0);\n"
+        "}\n"
+        "void main() {\n"
+        "  vec4 color = read_input(vTexCoord);\n"
+        "  for (int i = 0; i < uIterations; ++i) {\n"
+        "    color.rgb = color.rgb * 0.999 + sin(color.gbr * 6.2831 + float(i)) * 0.001;\n"
+        "  }\n"
+        "  FragColor = vec4(color.rgb, 1.0);\n"
+        "}\n";
+
+} /* namespace */
+
+namespace bnb::oep::benchmarks
+{
+
+    /* mock_effect_player::mock_effect_player */
+    mock_effect_player::mock_effect_player(const config& cfg)
+        : m_config(cfg)
+        , m_random(cfg.seed)
+    {
+    }
+
+    /* mock_effect_player::~mock_effect_player */
+    mock_effect_player::~mock_effect_player()
+    {
+        /* GL objects are released in surface_destroyed() with the active context */
+    }
+
+    /* mock_effect_player::surface_created */
+    void mock_effect_player::surface_created(int32_t width, int32_t height)
+    {
+        m_surface_width = width;
+        m_surface_height = height;
+        if (m_program == nullptr) {
+            m_program = std::make_unique<program>("mock_effect", mock_vertex_shader, mock_fragment_shader);
+            GL_CALL(glGenVertexArrays(1, &m_vao));
+        }
+    }
+
+    /* mock_effect_player::surface_changed */
+    void mock_effect_player::surface_changed(int32_t width, int32_t height)
+    {
+        m_surface_width = width;
+        m_surface_height = height;
+    }
+
+    /* mock_effect_player::surface_destroyed */
+    void mock_effect_player::surface_destroyed()
+    {
+        delete_gl_objects();
+    }
+
+    /* mock_effect_player::load_effect */
+    bool mock_effect_player::load_effect(const std::string& effect)
+    {
+        return true;
+    }
+
+    /* mock_effect_player::call_js_method */
+    bool mock_effect_player::call_js_method(const std::string& method, const std::string& param)
+    {
+        return true;
+    }
+
+    /* mock_effect_player::eval_js */
+    void mock_effect_player::eval_js(const std::string& script, oep_eval_js_result_cb result_callback)
+    {
+        if (result_callback) {
+            result_callback("");
+        }
+    }
+
+    /* mock_effect_player::pause */
+    void mock_effect_player::pause()
+    {
+        m_paused = true;
+    }
+
+    /* mock_effect_player::resume */
+    void mock_effect_player::resume()
+    {
+        m_paused = false;
+    }
+
+    /* mock_effect_player::stop */
+    void mock_effect_player::stop()
+    {
+        m_paused = true;
+    }
+
+    /* mock_effect_player::push_frame */
+    void mock_effect_player::push_frame(pixel_buffer_sptr image, bnb::oep::interfaces::rotation image_orientation, bool require_mirroring)
+    {
+        using ns = bnb::oep::interfaces::image_format;
+        /* the order of the channels and the color standard do not matter for the simulated load */
+        switch (image->get_image_format()) {
+            case ns::bpc8_rgb:
+            case ns::bpc8_bgr:
+                upload_plane(m_textures[0], image, 0, GL_RGB8, GL_RGB);
+                m_input_format = input_format::rgba;
+                break;
+            case ns::bpc8_rgba:
+            case ns::bpc8_bgra:
+            case ns::bpc8_argb:
+                upload_plane(m_textures[0], image, 0, GL_RGBA8, GL_RGBA);
+                m_input_format = input_format::rgba;
+                break;
+            case ns::nv12_bt601_full:
+            case ns::nv12_bt601_video:
+            case ns::nv12_bt709_full:
+            case ns::nv12_bt709_video:
+                upload_plane(m_textures[0], image, 0, GL_R8, GL_RED);
+                upload_plane(m_textures[1], image, 1, GL_RG8, GL_RG);
+                m_input_format = input_format::nv12;
+                break;
+            case ns::i420_bt601_full:
+            case ns::i420_bt601_video:
+            case ns::i420_bt709_full:
+            case ns::i420_bt709_video:
+                upload_plane(m_textures[0], image, 0, GL_R8, GL_RED);
+                upload_plane(m_textures[1], image, 1, GL_R8, GL_RED);
+                upload_plane(m_textures[2], image, 2, GL_R8, GL_RED);
+                m_input_format = input_format::i420;
+                break;
+        }
+        m_has_frame = true;
+    }
+
+    /* mock_effect_player::draw */
+    int64_t mock_effect_player::draw()
+    {
+        if (m_paused || !m_has_frame || m_program == nullptr) {
+            return -1;
+        }
+
+        /* draws into the framebuffer prepared by the offscreen render target */
+        GL_CALL(glViewport(0, 0, m_surface_width, m_surface_height));
+        GL_CALL(glDisable(GL_BLEND));
+        m_program->use();
+        m_program->set_uniform("uTexture", 0);
+        m_program->set_uniform("uTextureU", 1);
+        m_program->set_uniform("uTextureV", 2);
+        m_program->set_uniform("uInputFormat", static_cast<int32_t>(m_input_format));
+        m_program->set_uniform("uIterations", apply_jitter(m_config.gpu_iterations));
+        for (int32_t i = 2; i >= 0; --i) {
+            GL_CALL(glActiveTexture(GL_TEXTURE0 + i));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, m_textures[i].id));
+        }
+        GL_CALL(glBindVertexArray(m_vao));
+        for (int32_t i = 0; i < m_config.gpu_passes; ++i) {
+            GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 3));
+        }
+        GL_CALL(glBindVertexArray(0));
+        for (int32_t i = 2; i >= 0; --i) {
+            GL_CALL(glActiveTexture(GL_TEXTURE0 + i));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+        }
+        m_program->unuse();
+
+        auto cpu_cost = std::chrono::microseconds(apply_jitter(m_config.cpu_cost_us));
+        if (cpu_cost.count() > 0) {
+            /* busy wait, as the real effect player keeps the render thread busy */
+            auto deadline = std::chrono::steady_clock::now() + cpu_cost;
+            while (std::chrono::steady_clock::now() < deadline) {
+            }
+        }
+        return m_frame_number++;
+    }
+
+    /* mock_effect_player::upload_plane */
+    void mock_effect_player::upload_plane(plane_texture& texture, const pixel_buffer_sptr& image, int32_t plane, int32_t internal_format, uint32_t format)
+    {
+        auto width = image->get_width_of_plane(plane);
+        auto height = image->get_height_of_plane(plane);
+        if (texture.id == 0 || texture.width != width || texture.height != height || texture.internal_format != internal_format) {
+            if (texture.id != 0) {
+                GL_CALL(glDeleteTextures(1, &texture.id));
+            }
+            GL_CALL(glGenTextures(1, &texture.id));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, texture.id));
+            GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            texture.width = width;
+            texture.height = height;
+            texture.internal_format = internal_format;
+        }
+
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, texture.id));
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, image->get_bytes_per_row_of_plane(plane) / image->get_bytes_per_pixel_of_plane(plane)));
+        GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, image->get_base_sptr_of_plane(plane).get()));
+        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+    }
+
+    /* mock_effect_player::apply_jitter */
+    int32_t mock_effect_player::apply_jitter(int32_t value)
+    {
+        if (m_config.cost_jitter_percent <= 0 || value <= 0) {
+            return value;
+        }
+        auto deviation = value * m_config.cost_jitter_percent / 100;
+        std::uniform_int_distribution<int32_t> distribution(-deviation, deviation);
+        return std::max(0, value + distribution(m_random));
+    }
+
+    /* mock_effect_player::delete_gl_objects */
+    void mock_effect_player::delete_gl_objects()
+    {
+        for (auto& texture : m_textures) {
+            if (texture.id != 0) {
+                GL_CALL(glDeleteTextures(1, &texture.id));
+            }
+            texture = {};
+        }
+        if (m_vao != 0) {
+            GL_CALL(glDeleteVertexArrays(1, &m_vao));
+            m_vao = 0;
+        }
+        m_program.reset();
+        m_has_frame = false;
+    }
+
+} /* namespace bnb::oep::benchmarks */
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <interfaces/effect_player.hpp>
+#include <opengl/program.hpp>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+namespace bnb::oep::benchmarks
+{
+
+    /* Effect player simulating the load of a real effect without the Banuba SDK. The frame of any format
+     * is uploaded to the textures plane by plane and drawn into the prepared framebuffer by a fragment shader with the configurable number
+     * of the passes and arithmetic per pixel, then the CPU is kept busy for the configurable time */
+    class mock_effect_player : public bnb::oep::interfaces::effect_player
+    {
+    public:
+        struct config
+        {
+            /* number of the full screen passes of the draw() */
+            int32_t gpu_passes{1};
+            /* number of the iterations of the arithmetic loop per pixel in each pass */
+            int32_t gpu_iterations{16};
+            /* time of the busy wait of the draw() in microseconds */
+            int32_t cpu_cost_us{0};
+            /* random deviation of the CPU and GPU cost in percent, 0 for the fixed cost */
+            int32_t cost_jitter_percent{0};
+            /* seed of the random deviation, so the runs are reproducible */
+            uint32_t seed{1};
+        }; /* struct config */
+
+    public:
+        explicit mock_effect_player(const config& cfg);
+
+        ~mock_effect_player();
+
+        void surface_created(int32_t width, int32_t height) override;
+
+        void surface_changed(int32_t width, int32_t height) override;
+
+        void surface_destroyed() override;
+
+        bool load_effect(const std::string& effect) override;
+
+        bool call_js_method(const std::string& method, const std::string& param) override;
+
+        void eval_js(const std::string& script, oep_eval_js_result_cb result_callback) override;
+
+        void pause() override;
+
+        void resume() override;
+
+        void stop() override;
+
+        void push_frame(pixel_buffer_sptr image, bnb::oep::interfaces::rotation image_orientation, bool require_mirroring) override;
+
+        int64_t draw() override;
+
+    private:
+        struct plane_texture
+        {
+            uint32_t id{0};
+            int32_t width{0};
+            int32_t height{0};
+            int32_t internal_format{0};
+        }; /* struct plane_texture */
+
+        /* input formats known by the shader */
+        enum class input_format : int32_t
+        {
+            rgba = 0,
+            nv12 = 1,
+            i420 = 2
+        }; /* enum class input_format */
+
+        /* upload the plane of the image into the texture, the texture is recreated if the plane size changes */
+        void upload_plane(plane_texture& texture, const pixel_buffer_sptr& image, int32_t plane, int32_t internal_format, uint32_t format);
+
+        /* returns the value deviated according to cost_jitter_percent */
+        int32_t apply_jitter(int32_t value);
+
+        void delete_gl_objects();
+
+    private:
+        config m_config;
+        std::mt19937 m_random;
+        std::unique_ptr<program> m_program;
+        uint32_t m_vao{0};
+        plane_texture m_textures[3];
+        input_format m_input_format{input_format::rgba};
+        int32_t m_surface_width{0};
+        int32_t m_surface_height{0};
+        int64_t m_frame_number{0};
+        bool m_has_frame{false};
+        bool m_paused{false};
+    }; /* class mock_effect_player */
+
+} /* namespace bnb::oep::benchmarks */
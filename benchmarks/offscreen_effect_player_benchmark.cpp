@@ -0,0 +1,131 @@
+#include "benchmark_utils.hpp"
+
+#include <interfaces/offscreen_effect_player.hpp>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+
+    using namespace bnb::oep::benchmarks;
+    using bnb::oep::interfaces::frame_drop_reason;
+    using bnb::oep::interfaces::image_format;
+    using bnb::oep::interfaces::rotation;
+
+    /* number of the frames submitted per iteration of the throughput benchmark */
+    constexpr int32_t frames_per_iteration = 30;
+
+    offscreen_effect_player_sptr make_offscreen_effect_player(int32_t width, int32_t height, const mock_effect_player::config& cfg)
+    {
+        auto ep = std::make_shared<mock_effect_player>(cfg);
+        auto ort = bnb::oep::interfaces::offscreen_render_target::create(std::make_shared<headless_render_context>());
+        return bnb::oep::interfaces::offscreen_effect_player::create(ep, ort, width, height);
+    }
+
+    void report_stats(benchmark::State& state, const offscreen_effect_player_sptr& oep)
+    {
+        /* the latency of the frame is recorded after the return from its callback */
+        oep->flush();
+        auto stats = oep->get_stats();
+        state.counters["p50_ms"] = static_cast<double>(stats.latency.p50_ns) / 1e6;
+        state.counters["p95_ms"] = static_cast<double>(stats.latency.p95_ns) / 1e6;
+        state.counters["p99_ms"] = static_cast<double>(stats.latency.p99_ns) / 1e6;
+        uint64_t dropped = 0;
+        for (auto count : stats.dropped) {
+            dropped += count;
+        }
+        state.counters["dropped"] = static_cast<double>(dropped);
+    }
+
+    /* Frames per second of the whole pipeline in the offline mode: rendering, readback and conversion in the callback.
+     * Arguments: width, height, pipeline depth, output image format */
+    void process_image_async_throughput(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        auto format = static_cast<image_format>(state.range(3));
+        auto oep = make_offscreen_effect_player(width, height, {});
+        oep->set_processing_mode(bnb::oep::interfaces::processing_mode::offline);
+        oep->set_pipeline_depth(static_cast<int32_t>(state.range(2)));
+        auto image = make_rgba_image(width, height);
+        auto callback = [format](image_processing_result_sptr result) {
+            if (result != nullptr) {
+                result->get_image(format, [](pixel_buffer_sptr image) { benchmark::DoNotOptimize(image); });
+            }
+        };
+
+        /* warm up, so the creation of the textures and the buffers is not measured */
+        oep->process_image_async(image, rotation::deg0, false, callback, rotation::deg0);
+        oep->flush();
+        oep->reset_stage_histograms();
+
+        for (auto _ : state) {
+            for (int32_t i = 0; i < frames_per_iteration; ++i) {
+                oep->process_image_async(image, rotation::deg0, false, callback, rotation::deg0);
+            }
+            oep->flush();
+        }
+        state.SetItemsProcessed(state.iterations() * frames_per_iteration);
+        report_stats(state, oep);
+    }
+
+    /* Time from process_image_async() to the callback of the same frame with the empty pipeline.
+     * Arguments: width, height, CPU cost of the effect in microseconds */
+    void process_image_async_latency(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        mock_effect_player::config cfg;
+        cfg.cpu_cost_us = static_cast<int32_t>(state.range(2));
+        auto oep = make_offscreen_effect_player(width, height, cfg);
+        oep->set_pipeline_depth(bnb::oep::interfaces::offscreen_effect_player::pipeline_depth_low_latency);
+        auto image = make_rgba_image(width, height);
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done = false;
+        auto callback = [&](image_processing_result_sptr result) {
+            if (result != nullptr) {
+                result->get_image(image_format::bpc8_rgba, [](pixel_buffer_sptr image) { benchmark::DoNotOptimize(image); });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+            condition.notify_one();
+        };
+        auto process_frame = [&]() {
+            done = false;
+            oep->process_image_async(image, rotation::deg0, false, callback, rotation::deg0);
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&done]() { return done; });
+        };
+
+        process_frame();
+        oep->reset_stage_histograms();
+
+        for (auto _ : state) {
+            process_frame();
+        }
+        state.SetItemsProcessed(state.iterations());
+        report_stats(state, oep);
+    }
+
+} /* namespace */
+
+BENCHMARK(process_image_async_throughput)
+    ->ArgNames({"width", "height", "depth", "format"})
+    ->Args({1280, 720, 1, static_cast<int64_t>(image_format::bpc8_rgba)})
+    ->Args({1280, 720, 3, static_cast<int64_t>(image_format::bpc8_rgba)})
+    ->Args({1280, 720, 3, static_cast<int64_t>(image_format::nv12_bt601_video)})
+    ->Args({1920, 1080, 1, static_cast<int64_t>(image_format::bpc8_rgba)})
+    ->Args({1920, 1080, 3, static_cast<int64_t>(image_format::bpc8_rgba)})
+    ->Args({1920, 1080, 3, static_cast<int64_t>(image_format::i420_bt709_video)})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(process_image_async_latency)
+    ->ArgNames({"width", "height", "cpu_cost_us"})
+    ->Args({1280, 720, 0})
+    ->Args({1280, 720, 5000})
+    ->Args({1920, 1080, 0})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,153 @@
+#include "benchmark_utils.hpp"
+
+#include <interfaces/image_processing_result.hpp>
+
+namespace
+{
+
+    using namespace bnb::oep::benchmarks;
+    using bnb::oep::interfaces::image_format;
+    using bnb::oep::interfaces::rotation;
+
+    /* Render target without the NV12 readback, like the implementations of the applications reading I420 only,
+     * so image_processing_result converts the I420 image to NV12 in software by convert_image_to_nv12() */
+    class i420_only_render_target : public bnb::oep::interfaces::offscreen_render_target
+    {
+    public:
+        explicit i420_only_render_target(offscreen_render_target_sptr ort)
+            : m_ort(std::move(ort))
+        {
+        }
+
+        void init(int32_t width, int32_t height) override { m_ort->init(width, height); }
+        void deinit() override { m_ort->deinit(); }
+        void surface_changed(int32_t width, int32_t height) override { m_ort->surface_changed(width, height); }
+        void activate_context() override { m_ort->activate_context(); }
+        void deactivate_context() override { m_ort->deactivate_context(); }
+        int32_t set_buffer_count(int32_t count) override { return m_ort->set_buffer_count(count); }
+        void set_current_buffer_index(int32_t index) override { m_ort->set_current_buffer_index(index); }
+        void prepare_rendering() override { m_ort->prepare_rendering(); }
+        void orient_image(rotation orient) override { m_ort->orient_image(orient); }
+        rendered_texture_t get_current_buffer_texture() override { return m_ort->get_current_buffer_texture(); }
+        std::shared_ptr<uint8_t> allocate_buffer(size_t size) override { return m_ort->allocate_buffer(size); }
+
+        pixel_buffer_sptr read_current_buffer(image_format format) override
+        {
+            return is_nv12(format) ? nullptr : m_ort->read_current_buffer(format);
+        }
+
+        pixel_buffer_sptr read_current_buffer(const bnb::oep::interfaces::output_spec& output) override
+        {
+            return is_nv12(output.format) ? nullptr : m_ort->read_current_buffer(output);
+        }
+
+    private:
+        static bool is_nv12(image_format format)
+        {
+            return format >= image_format::nv12_bt601_full && format <= image_format::nv12_bt709_video;
+        }
+
+    private:
+        offscreen_render_target_sptr m_ort;
+    }; /* class i420_only_render_target */
+
+    /* Rendering of the frame and reading of the current buffer in the format.
+     * Arguments: width, height, image format */
+    void read_current_buffer(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        auto format = static_cast<image_format>(state.range(2));
+        auto ort = make_active_render_target(width, height);
+        mock_effect_player ep({});
+        ep.surface_created(width, height);
+        auto image = make_rgba_image(width, height);
+
+        for (auto _ : state) {
+            render_frame(ort, ep, image, rotation::deg0);
+            auto output = ort->read_current_buffer(format);
+            benchmark::DoNotOptimize(output);
+            if (output == nullptr) {
+                state.SkipWithError("The format is not supported by the offscreen render target.");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        ep.surface_destroyed();
+    }
+
+    /* Reading of the result via image_processing_result::get_image(), both NV12 and I420 are read on the GPU.
+     * Arguments: width, height, image format */
+    void image_processing_result_get_image(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        auto format = static_cast<image_format>(state.range(2));
+        auto ort = make_active_render_target(width, height);
+        mock_effect_player ep({});
+        ep.surface_created(width, height);
+        auto image = make_rgba_image(width, height);
+        auto result = bnb::oep::interfaces::image_processing_result::create(ort);
+
+        result->lock();
+        for (auto _ : state) {
+            render_frame(ort, ep, image, rotation::deg0);
+            result->get_image(format, [](pixel_buffer_sptr output) { benchmark::DoNotOptimize(output); });
+        }
+        result->unlock();
+        state.SetItemsProcessed(state.iterations());
+        ep.surface_destroyed();
+    }
+
+    /* Reading of the result via image_processing_result::get_image() from the render target without the NV12
+     * readback: the I420 image is read on the GPU and converted to NV12 by convert_image_to_nv12().
+     * Arguments: width, height, image format */
+    void image_processing_result_convert_to_nv12(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        auto format = static_cast<image_format>(state.range(2));
+        auto ort = std::make_shared<i420_only_render_target>(make_active_render_target(width, height));
+        mock_effect_player ep({});
+        ep.surface_created(width, height);
+        auto image = make_rgba_image(width, height);
+        auto result = bnb::oep::interfaces::image_processing_result::create(ort);
+
+        result->lock();
+        for (auto _ : state) {
+            render_frame(ort, ep, image, rotation::deg0);
+            pixel_buffer_sptr output;
+            result->get_image(format, [&output](pixel_buffer_sptr image) { output = std::move(image); });
+            benchmark::DoNotOptimize(output);
+            if (output == nullptr) {
+                state.SkipWithError("The software conversion to NV12 failed.");
+                break;
+            }
+        }
+        result->unlock();
+        state.SetItemsProcessed(state.iterations());
+        ep.surface_destroyed();
+    }
+
+} /* namespace */
+
+BENCHMARK(read_current_buffer)
+    ->ArgNames({"width", "height", "format"})
+    ->ArgsProduct({{1280}, {720}, all_image_formats})
+    ->ArgsProduct({{1920}, {1080}, all_image_formats})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(image_processing_result_get_image)
+    ->ArgNames({"width", "height", "format"})
+    ->ArgsProduct({{1280}, {720}, {static_cast<int64_t>(image_format::nv12_bt601_video), static_cast<int64_t>(image_format::i420_bt601_video)}})
+    ->ArgsProduct({{1920}, {1080}, {static_cast<int64_t>(image_format::nv12_bt601_video), static_cast<int64_t>(image_format::i420_bt601_video)}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(image_processing_result_convert_to_nv12)
+    ->ArgNames({"width", "height", "format"})
+    ->ArgsProduct({{1280}, {720}, {static_cast<int64_t>(image_format::nv12_bt601_video), static_cast<int64_t>(image_format::nv12_bt709_full)}})
+    ->ArgsProduct({{1920}, {1080}, {static_cast<int64_t>(image_format::nv12_bt601_video), static_cast<int64_t>(image_format::nv12_bt709_full)}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
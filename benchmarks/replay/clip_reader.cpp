@@ -0,0 +1,266 @@
+#include "clip_reader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif /* defined(_WIN32) */
+
+namespace bnb::oep::benchmarks
+{
+
+    /* mapped_file::mapped_file */
+    mapped_file::mapped_file(const std::string& path)
+    {
+#if defined(_WIN32)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            throw std::runtime_error("[ERROR] Failed to open file: " + path);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_file, &size);
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr) {
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (m_data == nullptr) {
+            throw std::runtime_error("[ERROR] Failed to map file: " + path);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("[ERROR] Failed to open file: " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("[ERROR] Failed to get size of file or file is empty: " + path);
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        /* the mapping stays valid after closing the descriptor */
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("[ERROR] Failed to map file: " + path);
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(data);
+#endif /* defined(_WIN32) */
+    }
+
+    /* mapped_file::~mapped_file */
+    mapped_file::~mapped_file()
+    {
+#if defined(_WIN32)
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != nullptr) {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_data != nullptr) {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+#endif /* defined(_WIN32) */
+    }
+
+    /* clip_reader::clip_reader */
+    clip_reader::clip_reader(std::shared_ptr<mapped_file> file, bnb::oep::interfaces::image_format format, int32_t width, int32_t height)
+        : m_file(std::move(file))
+        , m_format(format)
+        , m_width(width)
+        , m_height(height)
+    {
+    }
+
+    /* clip_reader::open_y4m */
+    std::shared_ptr<clip_reader> clip_reader::open_y4m(const std::string& path)
+    {
+        using ns = bnb::oep::interfaces::image_format;
+        auto file = std::make_shared<mapped_file>(path);
+        auto begin = reinterpret_cast<const char*>(file->data());
+        auto end = begin + file->size();
+
+        static const std::string signature = "YUV4MPEG2 ";
+        auto header_end = std::find(begin, end, '\n');
+        if (file->size() < signature.size() || std::string(begin, signature.size()) != signature || header_end == end) {
+            throw std::runtime_error("[ERROR] Invalid Y4M header: " + path);
+        }
+
+        int32_t width{0};
+        int32_t height{0};
+        int32_t rate_num{0};
+        int32_t rate_den{1};
+        bool full_range{false};
+        std::istringstream header(std::string(begin + signature.size(), header_end));
+        std::string token;
+        while (header >> token) {
+            switch (token[0]) {
+                case 'W':
+                    width = std::stoi(token.substr(1));
+                    break;
+                case 'H':
+                    height = std::stoi(token.substr(1));
+                    break;
+                case 'F':
+                    if (std::sscanf(token.c_str() + 1, "%d:%d", &rate_num, &rate_den) != 2 || rate_den == 0) {
+                        rate_num = 0;
+                        rate_den = 1;
+                    }
+                    break;
+                case 'C':
+                    /* the 8 bit variants of 4:2:0 differ only in the chroma siting, which does not matter here.
+                    The high bit depth ones, e.g. C420p10, have two bytes per sample */
+                    if (token != "C420" && token != "C420jpeg" && token != "C420paldv" && token != "C420mpeg2") {
+                        throw std::runtime_error("[ERROR] Only 8 bit 4:2:0 Y4M clips are supported, got: " + token);
+                    }
+                    break;
+                case 'X':
+                    if (token == "XCOLORRANGE=FULL") {
+                        full_range = true;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (width <= 0 || height <= 0) {
+            throw std::runtime_error("[ERROR] Y4M header does not contain the frame size: " + path);
+        }
+
+        auto format = full_range ? ns::i420_bt601_full : ns::i420_bt601_video;
+        std::shared_ptr<clip_reader> clip(new clip_reader(file, format, width, height));
+        clip->m_frame_rate = static_cast<double>(rate_num) / rate_den;
+
+        /* each frame is "FRAME[ parameters]\n" followed by the planes */
+        auto frame_size = calc_frame_size(format, width, height);
+        auto pos = header_end + 1;
+        static const std::string frame_tag = "FRAME";
+        while (end - pos > static_cast<ptrdiff_t>(frame_tag.size()) && std::string(pos, frame_tag.size()) == frame_tag) {
+            auto frame_header_end = std::find(pos, end, '\n');
+            if (frame_header_end == end || static_cast<size_t>(end - frame_header_end - 1) < frame_size) {
+                /* the last frame is truncated */
+                break;
+            }
+            clip->m_frame_offsets.push_back(static_cast<size_t>(frame_header_end + 1 - begin));
+            pos = frame_header_end + 1 + frame_size;
+        }
+        if (clip->m_frame_offsets.empty()) {
+            throw std::runtime_error("[ERROR] Y4M clip does not contain any frame: " + path);
+        }
+        return clip;
+    }
+
+    /* clip_reader::open_raw */
+    std::shared_ptr<clip_reader> clip_reader::open_raw(const std::string& path, bnb::oep::interfaces::image_format format, int32_t width, int32_t height)
+    {
+        if (width <= 0 || height <= 0) {
+            throw std::runtime_error("[ERROR] The frame size of the raw clip must be specified.");
+        }
+        auto file = std::make_shared<mapped_file>(path);
+        std::shared_ptr<clip_reader> clip(new clip_reader(file, format, width, height));
+        auto frame_size = calc_frame_size(format, width, height);
+        auto frame_count = file->size() / frame_size;
+        if (frame_count == 0) {
+            throw std::runtime_error("[ERROR] Raw clip is smaller than one frame: " + path);
+        }
+        if (file->size() % frame_size != 0) {
+            std::cout << "[WARNING] The size of the raw clip is not a multiple of the frame size, the tail is ignored" << std::endl;
+        }
+        for (size_t i = 0; i < frame_count; ++i) {
+            clip->m_frame_offsets.push_back(i * frame_size);
+        }
+        return clip;
+    }
+
+    /* clip_reader::calc_frame_size */
+    size_t clip_reader::calc_frame_size(bnb::oep::interfaces::image_format format, int32_t width, int32_t height)
+    {
+        using ns = bnb::oep::interfaces::image_format;
+        auto pixels = static_cast<size_t>(width) * height;
+        auto chroma_pixels = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+        switch (format) {
+            case ns::bpc8_rgb:
+            case ns::bpc8_bgr:
+                return pixels * 3;
+            case ns::bpc8_rgba:
+            case ns::bpc8_bgra:
+            case ns::bpc8_argb:
+                return pixels * 4;
+            case ns::nv12_bt601_full:
+            case ns::nv12_bt601_video:
+            case ns::nv12_bt709_full:
+            case ns::nv12_bt709_video:
+            case ns::i420_bt601_full:
+            case ns::i420_bt601_video:
+            case ns::i420_bt709_full:
+            case ns::i420_bt709_video:
+                return pixels + chroma_pixels * 2;
+        }
+        return 0;
+    }
+
+    /* clip_reader::get_frame */
+    pixel_buffer_sptr clip_reader::get_frame(size_t index) const
+    {
+        using ns = bnb::oep::interfaces::image_format;
+        using pb = bnb::oep::interfaces::pixel_buffer;
+
+        auto frame = const_cast<uint8_t*>(m_file->data() + m_frame_offsets.at(index));
+        /* the aliasing constructor shares the ownership of the mapping, so nothing is copied or allocated per plane */
+        auto plane = [this](uint8_t* data, size_t size, int32_t stride) {
+            return pb::plane_data{pb::plane_sptr(m_file, data), size, stride};
+        };
+
+        auto y_size = static_cast<size_t>(m_width) * m_height;
+        auto chroma_width = (m_width + 1) / 2;
+        auto chroma_size = static_cast<size_t>(chroma_width) * ((m_height + 1) / 2);
+        std::vector<pb::plane_data> planes;
+        switch (m_format) {
+            case ns::bpc8_rgb:
+            case ns::bpc8_bgr:
+                planes.push_back(plane(frame, y_size * 3, m_width * 3));
+                break;
+            case ns::bpc8_rgba:
+            case ns::bpc8_bgra:
+            case ns::bpc8_argb:
+                planes.push_back(plane(frame, y_size * 4, m_width * 4));
+                break;
+            case ns::nv12_bt601_full:
+            case ns::nv12_bt601_video:
+            case ns::nv12_bt709_full:
+            case ns::nv12_bt709_video:
+                planes.push_back(plane(frame, y_size, m_width));
+                planes.push_back(plane(frame + y_size, chroma_size * 2, chroma_width * 2));
+                break;
+            case ns::i420_bt601_full:
+            case ns::i420_bt601_video:
+            case ns::i420_bt709_full:
+            case ns::i420_bt709_video:
+                planes.push_back(plane(frame, y_size, m_width));
+                planes.push_back(plane(frame + y_size, chroma_size, chroma_width));
+                planes.push_back(plane(frame + y_size + chroma_size, chroma_size, chroma_width));
+                break;
+        }
+        return pb::create(planes, m_format, m_width, m_height);
+    }
+
+} /* namespace bnb::oep::benchmarks */
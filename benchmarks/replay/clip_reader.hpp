@@ -0,0 +1,105 @@
+#pragma once
+
+#include <interfaces/pixel_buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bnb::oep::benchmarks
+{
+
+    /* Read only memory mapping of the whole file */
+    class mapped_file
+    {
+    public:
+        explicit mapped_file(const std::string& path);
+
+        ~mapped_file();
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const uint8_t* data() const
+        {
+            return m_data;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+        const uint8_t* m_data{nullptr};
+        size_t m_size{0};
+#if defined(_WIN32)
+        void* m_file{nullptr};
+        void* m_mapping{nullptr};
+#endif /* defined(_WIN32) */
+    }; /* class mapped_file */
+
+    /* Video clip in the raw or the Y4M format. The file is memory mapped and the frames are wrapped into
+     * pixel buffers pointing directly into the mapping, so reading a frame never copies the pixels.
+     * The pixel buffers keep the mapping alive and must be treated as read only.
+     * Y4M clips must have 4:2:0 chroma subsampling and are read as i420, the raw clips contain the frames
+     * of the specified format one after another without any headers
+     *
+     * @example
+     * auto clip = clip_reader::open_y4m("clip.y4m");
+     * auto clip = clip_reader::open_raw("clip.rgba", image_format::bpc8_rgba, 1920, 1080);
+     * for (size_t i = 0; i < clip->get_frame_count(); ++i) { auto frame = clip->get_frame(i); }
+     */
+    class clip_reader
+    {
+    public:
+        static std::shared_ptr<clip_reader> open_y4m(const std::string& path);
+
+        static std::shared_ptr<clip_reader> open_raw(const std::string& path, bnb::oep::interfaces::image_format format, int32_t width, int32_t height);
+
+        /* calculate the size in bytes of the tightly packed frame */
+        static size_t calc_frame_size(bnb::oep::interfaces::image_format format, int32_t width, int32_t height);
+
+        size_t get_frame_count() const
+        {
+            return m_frame_offsets.size();
+        }
+
+        int32_t get_width() const
+        {
+            return m_width;
+        }
+
+        int32_t get_height() const
+        {
+            return m_height;
+        }
+
+        bnb::oep::interfaces::image_format get_image_format() const
+        {
+            return m_format;
+        }
+
+        /* frame rate from the header of the Y4M clip, zero if unknown */
+        double get_frame_rate() const
+        {
+            return m_frame_rate;
+        }
+
+        /* wrap the frame into the pixel buffer without copying */
+        pixel_buffer_sptr get_frame(size_t index) const;
+
+    private:
+        clip_reader(std::shared_ptr<mapped_file> file, bnb::oep::interfaces::image_format format, int32_t width, int32_t height);
+
+    private:
+        std::shared_ptr<mapped_file> m_file;
+        bnb::oep::interfaces::image_format m_format;
+        int32_t m_width;
+        int32_t m_height;
+        double m_frame_rate{0.0};
+        std::vector<size_t> m_frame_offsets;
+    }; /* class clip_reader */
+
+} /* namespace bnb::oep::benchmarks */
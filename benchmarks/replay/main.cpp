@@ -0,0 +1,403 @@
+#include "clip_reader.hpp"
+#include "../headless_render_context.hpp"
+#include "../mock_effect_player.hpp"
+
+#include <interfaces/offscreen_effect_player.hpp>
+#include <profiling/clock.hpp>
+#include <profiling/trace.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* End-to-end replay of a raw or Y4M clip through the offscreen effect player with the mock effect player.
+ * The frames are submitted at the specified rate, or as fast as possible, the result of each frame is read
+ * in the specified format, and the throughput, the drop rate and the latency percentiles are reported.
+ *
+ * @example
+ * bnb_oep_replay --input clip.y4m --rate 30 --output-format nv12_bt601_video
+ * bnb_oep_replay --input clip.rgba --format bpc8_rgba --width 1920 --height 1080 --offline --frames 1000
+ */
+
+namespace
+{
+
+    using bnb::oep::interfaces::backpressure_policy;
+    using bnb::oep::interfaces::frame_drop_reason;
+    using bnb::oep::interfaces::frame_stage;
+    using bnb::oep::interfaces::image_format;
+    using bnb::oep::interfaces::output_spec;
+    using bnb::oep::interfaces::resample_filter;
+    using bnb::oep::interfaces::rotation;
+
+    struct replay_options
+    {
+        std::string input;
+        /* the format and the size are required for the raw clips only */
+        std::string input_format;
+        int32_t width{0};
+        int32_t height{0};
+        /* input frame rate, zero to submit the frames as fast as possible, negative to use the rate of the Y4M clip */
+        double rate{-1.0};
+        /* number of the frames to submit, the clip is looped if it is shorter. Zero to play the clip once */
+        int64_t frames{0};
+        image_format output_format{image_format::bpc8_rgba};
+        rotation orientation{rotation::deg0};
+        /* the outputs read from the same rendered frame in addition to the output format */
+        std::vector<output_spec> extra_outputs;
+        backpressure_policy policy{backpressure_policy::latest_wins};
+        int32_t queue_depth{bnb::oep::interfaces::offscreen_effect_player::frame_queue_depth_default};
+        int32_t pipeline_depth{0};
+        int32_t result_pool_size{0};
+        /* number of the last results kept locked after the callback, as the encoder does */
+        int32_t hold_results{0};
+        bool offline{false};
+        /* pass the output format to process_image_async() to be prefetched */
+        bool prefetch{false};
+        bool gpu_timers{false};
+        std::string trace;
+        bnb::oep::benchmarks::mock_effect_player::config effect;
+    }; /* struct replay_options */
+
+    const std::map<std::string, image_format> image_format_names{
+        {"bpc8_rgb", image_format::bpc8_rgb},
+        {"bpc8_bgr", image_format::bpc8_bgr},
+        {"bpc8_rgba", image_format::bpc8_rgba},
+        {"bpc8_bgra", image_format::bpc8_bgra},
+        {"bpc8_argb", image_format::bpc8_argb},
+        {"nv12_bt601_full", image_format::nv12_bt601_full},
+        {"nv12_bt601_video", image_format::nv12_bt601_video},
+        {"nv12_bt709_full", image_format::nv12_bt709_full},
+        {"nv12_bt709_video", image_format::nv12_bt709_video},
+        {"i420_bt601_full", image_format::i420_bt601_full},
+        {"i420_bt601_video", image_format::i420_bt601_video},
+        {"i420_bt709_full", image_format::i420_bt709_full},
+        {"i420_bt709_video", image_format::i420_bt709_video}};
+
+    const std::map<std::string, backpressure_policy> policy_names{
+        {"latest_wins", backpressure_policy::latest_wins},
+        {"drop_oldest", backpressure_policy::drop_oldest},
+        {"block_producer", backpressure_policy::block_producer},
+        {"lossless_fifo", backpressure_policy::lossless_fifo}};
+
+    const std::map<std::string, resample_filter> filter_names{
+        {"nearest", resample_filter::nearest},
+        {"bilinear", resample_filter::bilinear},
+        {"bicubic", resample_filter::bicubic},
+        {"lanczos", resample_filter::lanczos}};
+
+    const char* const drop_reason_names[]{"queue_full", "outdated", "result_locked", "stopped", "destroying"};
+
+    const char* const stage_names[]{
+        "queue_wait", "push_frame", "draw", "orient_image", "readback", "conversion", "callback", "total",
+        "gpu_draw", "gpu_orient_image", "gpu_yuv_y_plane", "gpu_yuv_u_plane", "gpu_yuv_v_plane",
+        "gpu_pack_pixels", "gpu_resample"};
+
+    void print_usage()
+    {
+        std::cout
+            << "Usage: bnb_oep_replay --input <clip> [options]\n"
+            << "  --input <path>              raw or Y4M (*.y4m) clip\n"
+            << "  --format <image_format>     format of the raw clip, e.g. bpc8_rgba, nv12_bt601_video\n"
+            << "  --width <n> --height <n>    frame size of the raw clip\n"
+            << "  --rate <fps>                input frame rate, 0 - as fast as possible. The rate of the Y4M clip by default\n"
+            << "  --frames <n>                number of the frames to submit, the clip is looped. The clip length by default\n"
+            << "  --output-format <format>    format requested via get_image(), bpc8_rgba by default\n"
+            << "  --orientation <0|90|180|270> target orientation, 0 by default\n"
+            << "  --extra-output <format>:<0|90|180|270>[:<width>x<height>[:<filter>]]\n"
+            << "                              one more output of the same frame, may be repeated. The output is resampled\n"
+            << "                              to the size by the filter nearest, bilinear (default), bicubic or lanczos\n"
+            << "  --policy <policy>           latest_wins (default), drop_oldest, block_producer, lossless_fifo\n"
+            << "  --queue-depth <n>           queue depth of the backpressure policy\n"
+            << "  --pipeline-depth <n>        number of the frames in the pipeline\n"
+            << "  --result-pool <n>           number of the image processing results\n"
+            << "  --hold-results <n>          keep the last n results locked after the callback\n"
+            << "  --offline                   offline processing mode, no frames are dropped\n"
+            << "  --prefetch                  start the readback of the output format at the submission of the frame\n"
+            << "  --gpu-timers                measure the GPU time of the passes\n"
+            << "  --trace <path>              write the Chrome trace, requires the build with USE_BNB_OEP_TRACING\n"
+            << "  --gpu-passes <n> --gpu-iterations <n> --cpu-cost-us <n> --cost-jitter <percent>\n"
+            << "                              load of the mock effect player" << std::endl;
+    }
+
+    replay_options parse_options(int argc, char** argv)
+    {
+        replay_options options;
+        auto value = [&](int& i) -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::string("[ERROR] Missing value of the option ") + argv[i]);
+            }
+            return argv[++i];
+        };
+        auto find = [](const auto& names, const std::string& name) {
+            auto it = names.find(name);
+            if (it == names.end()) {
+                throw std::runtime_error("[ERROR] Unknown value: " + name);
+            }
+            return it->second;
+        };
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--input") {
+                options.input = value(i);
+            } else if (arg == "--format") {
+                options.input_format = value(i);
+            } else if (arg == "--width") {
+                options.width = std::stoi(value(i));
+            } else if (arg == "--height") {
+                options.height = std::stoi(value(i));
+            } else if (arg == "--rate") {
+                options.rate = std::stod(value(i));
+            } else if (arg == "--frames") {
+                options.frames = std::stoll(value(i));
+            } else if (arg == "--output-format") {
+                options.output_format = find(image_format_names, value(i));
+            } else if (arg == "--orientation") {
+                options.orientation = static_cast<rotation>(std::stoi(value(i)) / 90 % 4);
+            } else if (arg == "--extra-output") {
+                /* the fields are separated by ':' */
+                std::vector<std::string> fields;
+                std::string spec = value(i);
+                for (size_t begin = 0, end = 0; end != std::string::npos; begin = end + 1) {
+                    end = spec.find(':', begin);
+                    fields.push_back(spec.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+                }
+                output_spec output;
+                output.format = find(image_format_names, fields[0]);
+                if (fields.size() > 1) {
+                    output.orientation = static_cast<rotation>(std::stoi(fields[1]) / 90 % 4);
+                }
+                if (fields.size() > 2) {
+                    auto x = fields[2].find('x');
+                    if (x == std::string::npos) {
+                        throw std::runtime_error("[ERROR] The size of the output must be <width>x<height>: " + fields[2]);
+                    }
+                    output.width = std::stoi(fields[2].substr(0, x));
+                    output.height = std::stoi(fields[2].substr(x + 1));
+                }
+                if (fields.size() > 3) {
+                    output.filter = find(filter_names, fields[3]);
+                }
+                options.extra_outputs.push_back(output);
+            } else if (arg == "--policy") {
+                options.policy = find(policy_names, value(i));
+            } else if (arg == "--queue-depth") {
+                options.queue_depth = std::stoi(value(i));
+            } else if (arg == "--pipeline-depth") {
+                options.pipeline_depth = std::stoi(value(i));
+            } else if (arg == "--result-pool") {
+                options.result_pool_size = std::stoi(value(i));
+            } else if (arg == "--hold-results") {
+                options.hold_results = std::stoi(value(i));
+            } else if (arg == "--offline") {
+                options.offline = true;
+            } else if (arg == "--prefetch") {
+                options.prefetch = true;
+            } else if (arg == "--gpu-timers") {
+                options.gpu_timers = true;
+            } else if (arg == "--trace") {
+                options.trace = value(i);
+            } else if (arg == "--gpu-passes") {
+                options.effect.gpu_passes = std::stoi(value(i));
+            } else if (arg == "--gpu-iterations") {
+                options.effect.gpu_iterations = std::stoi(value(i));
+            } else if (arg == "--cpu-cost-us") {
+                options.effect.cpu_cost_us = std::stoi(value(i));
+            } else if (arg == "--cost-jitter") {
+                options.effect.cost_jitter_percent = std::stoi(value(i));
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage();
+                std::exit(0);
+            } else {
+                throw std::runtime_error("[ERROR] Unknown option: " + arg);
+            }
+        }
+        if (options.input.empty()) {
+            throw std::runtime_error("[ERROR] The input clip is not specified.");
+        }
+        return options;
+    }
+
+    bool is_y4m(const std::string& path)
+    {
+        static const std::string extension = ".y4m";
+        return path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    double to_ms(int64_t ns)
+    {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    void print_histogram(const char* name, const bnb::oep::interfaces::latency_histogram_snapshot& h)
+    {
+        std::printf("  %-18s %8llu %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, static_cast<unsigned long long>(h.count),
+                    to_ms(h.mean_ns), to_ms(h.p50_ns), to_ms(h.p95_ns), to_ms(h.p99_ns), to_ms(h.max_ns));
+    }
+
+    int run(const replay_options& options)
+    {
+        using namespace bnb::oep::benchmarks;
+
+        auto clip = is_y4m(options.input)
+                        ? clip_reader::open_y4m(options.input)
+                        : clip_reader::open_raw(options.input, image_format_names.at(options.input_format.empty() ? "bpc8_rgba" : options.input_format), options.width, options.height);
+        auto rate = options.rate < 0.0 ? clip->get_frame_rate() : options.rate;
+        auto frames = options.frames > 0 ? options.frames : static_cast<int64_t>(clip->get_frame_count());
+
+        auto ep = std::make_shared<mock_effect_player>(options.effect);
+        auto ort = bnb::oep::interfaces::offscreen_render_target::create(std::make_shared<headless_render_context>());
+        auto oep = bnb::oep::interfaces::offscreen_effect_player::create(ep, ort, clip->get_width(), clip->get_height());
+        oep->set_backpressure_policy(options.policy, options.queue_depth);
+        if (options.offline) {
+            oep->set_processing_mode(bnb::oep::interfaces::processing_mode::offline);
+        }
+        if (options.pipeline_depth > 0) {
+            oep->set_pipeline_depth(options.pipeline_depth);
+        }
+        if (options.result_pool_size > 0) {
+            oep->set_result_pool_size(options.result_pool_size);
+        }
+        oep->set_gpu_timers_enabled(options.gpu_timers);
+
+        std::atomic<uint64_t> output_bytes{0};
+        std::atomic<uint64_t> output_failures{0};
+        auto output_format = options.output_format;
+        std::vector<image_format> prefetch_formats;
+        if (options.prefetch) {
+            prefetch_formats.push_back(output_format);
+        }
+        /* with the extra outputs all the outputs are produced from the single rendering of the frame */
+        std::vector<output_spec> outputs;
+        if (!options.extra_outputs.empty()) {
+            outputs.push_back({output_format, options.orientation});
+            outputs.insert(outputs.end(), options.extra_outputs.begin(), options.extra_outputs.end());
+        }
+        /* the callbacks are called on the render thread only */
+        std::deque<image_processing_result_sptr> held_results;
+        auto hold_results = static_cast<size_t>(options.hold_results);
+        auto callback = [&output_bytes, &output_failures, &held_results, &outputs, hold_results, output_format](image_processing_result_sptr result) {
+            if (result == nullptr) {
+                return;
+            }
+            if (hold_results > 0) {
+                result->lock();
+                held_results.push_back(result);
+                if (held_results.size() > hold_results) {
+                    held_results.front()->unlock();
+                    held_results.pop_front();
+                }
+            }
+            auto count_output = [&output_bytes, &output_failures](pixel_buffer_sptr image) {
+                if (image == nullptr) {
+                    output_failures.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                for (int32_t i = 0; i < image->get_plane_count(); ++i) {
+                    output_bytes.fetch_add(static_cast<uint64_t>(image->get_bytes_per_row_of_plane(i)) * image->get_height_of_plane(i), std::memory_order_relaxed);
+                }
+            };
+            if (outputs.empty()) {
+                result->get_image(output_format, count_output);
+            }
+            for (const auto& output : outputs) {
+                result->get_image(output, count_output);
+            }
+        };
+        auto submit = [&oep, &options, &callback, &prefetch_formats, &outputs](pixel_buffer_sptr frame) {
+            if (outputs.empty()) {
+                oep->process_image_async(frame, rotation::deg0, false, callback, options.orientation, prefetch_formats);
+            } else {
+                oep->process_image_outputs_async(frame, rotation::deg0, false, callback, outputs);
+            }
+        };
+
+        std::printf("Input: %s, %dx%d, %zu frames, rate %s\n", options.input.c_str(), clip->get_width(), clip->get_height(),
+                    clip->get_frame_count(), rate > 0.0 ? std::to_string(rate).c_str() : "unlimited");
+
+        /* the first frame creates the GL resources, so it is not measured */
+        submit(clip->get_frame(0));
+        oep->flush();
+        oep->reset_stage_histograms();
+        auto warmup_stats = oep->get_stats();
+        output_bytes = 0;
+
+        if (!options.trace.empty()) {
+            bnb::oep::profiling::trace_recorder::instance().start();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < frames; ++i) {
+            if (rate > 0.0) {
+                /* the schedule does not drift if the submission is late */
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(i / rate)));
+            }
+            submit(clip->get_frame(static_cast<size_t>(i) % clip->get_frame_count()));
+        }
+        oep->flush();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        /* no callbacks are called after the flush */
+        for (auto& result : held_results) {
+            result->unlock();
+        }
+        held_results.clear();
+
+        if (!options.trace.empty()) {
+            bnb::oep::profiling::trace_recorder::instance().stop();
+            if (!bnb::oep::profiling::trace_recorder::instance().write_chrome_trace(options.trace)) {
+                std::cout << "[WARNING] Failed to write the trace: " << options.trace << std::endl;
+            }
+        }
+
+        auto stats = oep->get_stats();
+        auto submitted = stats.submitted - warmup_stats.submitted;
+        auto processed = stats.processed - warmup_stats.processed;
+        uint64_t dropped = 0;
+        for (size_t i = 0; i < stats.dropped.size(); ++i) {
+            dropped += stats.dropped[i] - warmup_stats.dropped[i];
+        }
+
+        std::printf("Submitted: %llu, processed: %llu, dropped: %llu (%.2f%%)\n", static_cast<unsigned long long>(submitted),
+                    static_cast<unsigned long long>(processed), static_cast<unsigned long long>(dropped),
+                    submitted > 0 ? 100.0 * static_cast<double>(dropped) / static_cast<double>(submitted) : 0.0);
+        for (size_t i = 0; i < stats.dropped.size(); ++i) {
+            auto count = stats.dropped[i] - warmup_stats.dropped[i];
+            if (count > 0) {
+                std::printf("  dropped %-14s %llu\n", drop_reason_names[i], static_cast<unsigned long long>(count));
+            }
+        }
+        if (output_failures > 0) {
+            std::printf("Output format is not available for %llu frames\n", static_cast<unsigned long long>(output_failures.load()));
+        }
+        std::printf("Elapsed: %.3f s, throughput: %.2f fps, output: %.2f MB/s\n", elapsed, static_cast<double>(processed) / elapsed,
+                    static_cast<double>(output_bytes.load()) / elapsed / 1e6);
+
+        std::printf("Latency, ms:\n  %-18s %8s %9s %9s %9s %9s %9s\n", "stage", "count", "mean", "p50", "p95", "p99", "max");
+        print_histogram("end_to_end", stats.latency);
+        for (int32_t i = 0; i < static_cast<int32_t>(frame_stage::count); ++i) {
+            auto histogram = oep->get_stage_histogram(static_cast<frame_stage>(i));
+            if (histogram.count > 0) {
+                print_histogram(stage_names[i], histogram);
+            }
+        }
+        return 0;
+    }
+
+} /* namespace */
+
+int main(int argc, char** argv)
+{
+    try {
+        return run(parse_options(argc, argv));
+    } catch (std::exception& e) {
+        std::cout << e.what() << std::endl;
+        print_usage();
+        return 1;
+    }
+}
@@ -0,0 +1,46 @@
+#include "benchmark_utils.hpp"
+
+#include <opengl/yuv_converter.hpp>
+
+namespace
+{
+
+    using namespace bnb::oep::benchmarks;
+    using bnb::oep::converter::yuv_converter;
+
+    /* GPU conversion of the RGBA texture to the I420 planes and their readback.
+     * Arguments: width, height */
+    void yuv_converter_convert(benchmark::State& state)
+    {
+        auto width = static_cast<int32_t>(state.range(0));
+        auto height = static_cast<int32_t>(state.range(1));
+        auto ort = make_active_render_target(width, height);
+        mock_effect_player ep({});
+        ep.surface_created(width, height);
+        render_frame(ort, ep, make_rgba_image(width, height), bnb::oep::interfaces::rotation::deg0);
+        auto texture = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ort->get_current_buffer_texture()));
+
+        yuv_converter converter(yuv_converter::standard::bt601, yuv_converter::range::video_range);
+        /* the buffer is allocated by the first conversion and reused by the next ones, the planes are read
+        from the mapped memory as by the offscreen_render_target */
+        bnb::oep::pixel_pack_buffer output;
+
+        for (auto _ : state) {
+            converter.convert(texture, width, height, output);
+            benchmark::DoNotOptimize(output.map());
+            output.unmap();
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * width * height * 4);
+        ep.surface_destroyed();
+    }
+
+} /* namespace */
+
+BENCHMARK(yuv_converter_convert)
+    ->ArgNames({"width", "height"})
+    ->Args(frame_sizes[0])
+    ->Args(frame_sizes[1])
+    ->Args(frame_sizes[2])
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
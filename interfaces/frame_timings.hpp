@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace bnb::oep::interfaces
+{
+
+    /* Stages of the processing of a frame */
+    enum class frame_stage : int32_t
+    {
+        queue_wait,     /* from process_image_async() to the start of processing on the render thread */
+        push_frame,     /* effect_player::push_frame() */
+        draw,           /* effect_player::draw() */
+        orient_image,   /* offscreen_render_target::orient_image() */
+        readback,       /* offscreen_render_target::read_current_buffer() called by image_processing_result::get_image() */
+        conversion,     /* software conversion of the image in image_processing_result::get_image() */
+        callback,       /* the user callback of process_image_async(), including get_image() called from it */
+        total,          /* from process_image_async() to the return from the user callback */
+        /* the GPU stages are measured by the offscreen render target with timer queries. Their results are
+         * available a few frames later, so they are only aggregated and not set in frame_timings */
+        gpu_draw,           /* GPU time of the effect rendering, from prepare_rendering() to orient_image() */
+        gpu_orient_image,   /* GPU time of the orientation pass */
+        gpu_yuv_y_plane,    /* GPU time of the Y plane pass of the YUV conversion */
+        gpu_yuv_u_plane,    /* GPU time of the U plane pass of the YUV conversion */
+        gpu_yuv_v_plane,    /* GPU time of the V plane pass of the YUV conversion */
+        gpu_pack_pixels,    /* GPU time of the pass packing the pixels of the bpc8 formats */
+        gpu_resample,       /* GPU time of the passes resampling the image to the size of the output */
+        count
+    }; /* enum class frame_stage */
+
+    /* Monotonic timings of the processing of one frame */
+    struct frame_timings
+    {
+        static constexpr int64_t not_measured = -1;
+
+        /* steady clock timestamp of the call of process_image_async() in nanoseconds */
+        int64_t enqueue_time_ns{0};
+        /* durations of the stages in nanoseconds, not_measured if the stage was not executed */
+        std::array<int64_t, static_cast<size_t>(frame_stage::count)> durations_ns{};
+
+        frame_timings()
+        {
+            durations_ns.fill(not_measured);
+        }
+
+        int64_t get(frame_stage stage) const
+        {
+            return durations_ns[static_cast<size_t>(stage)];
+        }
+
+        void set(frame_stage stage, int64_t duration_ns)
+        {
+            durations_ns[static_cast<size_t>(stage)] = duration_ns;
+        }
+
+        /* accumulates the duration, since some stages may be executed several times per frame */
+        void add(frame_stage stage, int64_t duration_ns)
+        {
+            auto& d = durations_ns[static_cast<size_t>(stage)];
+            d = (d == not_measured ? 0 : d) + duration_ns;
+        }
+    }; /* struct frame_timings */
+
+    /* Aggregated distribution of durations in nanoseconds */
+    struct latency_histogram_snapshot
+    {
+        uint64_t count{0};
+        int64_t min_ns{0};
+        int64_t max_ns{0};
+        int64_t mean_ns{0};
+        int64_t p50_ns{0};
+        int64_t p95_ns{0};
+        int64_t p99_ns{0};
+    }; /* struct latency_histogram_snapshot */
+
+} /* namespace bnb::oep::interfaces */
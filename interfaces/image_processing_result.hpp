@@ -2,6 +2,7 @@
 
 #include <optional>
 #include <interfaces/image_format.hpp>
+#include <interfaces/frame_timings.hpp>
 #include <interfaces/pixel_buffer.hpp>
 #include <interfaces/offscreen_render_target.hpp>
 
@@ -24,18 +25,21 @@ namespace bnb::oep::interfaces
          * Create the image processing result. Called in offsceen effect player.
          *
          * @param ort shared pointer to the offscreen render target
+         * @param buffer_index index of the render buffer of the offscreen render target the result reads,
+         * so the result may be read while the next frames are rendered into the other buffers
          *
          * @return shared pointer to the image processing result
          *
-         * @example bnb::oep::interfaces::image_processing_result::create(my_ep, my_ort, width, height)
+         * @example bnb::oep::interfaces::image_processing_result::create(my_ort, 0)
          */
-        static image_processing_result_sptr create(offscreen_render_target_sptr ort);
+        static image_processing_result_sptr create(offscreen_render_target_sptr ort, int32_t buffer_index = 0);
 
         virtual ~image_processing_result() = default;
 
         /**
          * Lock pixel buffer. If you want to keep lock of pixel buffer
          * longer than output image callback scope you should lock pixel buffer.
+         * The render buffer of the locked result is not reused for the next frames.
          *
          * @example lock()
          */
@@ -43,7 +47,7 @@ namespace bnb::oep::interfaces
 
         /**
          * Unlock image_processing_result. Must be called if user explicitly called lock()
-         * after the work to process output pixel buffer completed.
+         * after the work to process output pixel buffer completed. May be called from any thread.
          *
          * @example unlock()
          */
@@ -69,6 +73,32 @@ namespace bnb::oep::interfaces
          */
         virtual void get_image(image_format format, oep_pixel_buffer_ready_cb callback) = 0;
 
+        /**
+         * In tread with active texture get pixel bytes of one of the outputs of the frame from Offscreen_render_target.
+         * The orientation and the size of the output may differ from the ones of the frame, the image is converted
+         * and resampled from the same rendered frame without the repeated rendering.
+         *
+         * @param output specifies the output image format, orientation and size, usually one of the outputs
+         * passed to offscreen_effect_player::process_image_outputs_async()
+         * @param callback calling with pixel_buffer_sptr
+         *
+         * @example get_image({image_format::nv12_bt709_video, rotation::deg90}, [](pixel_buffer_sptr image){})
+         */
+        virtual void get_image(const output_spec& output, oep_pixel_buffer_ready_cb callback) = 0;
+
+        /**
+         * In tread with active texture write the pixel bytes from Offscreen_render_target into the memory of
+         * the destination, e.g. the input surface of the encoder, without the intermediate copy. The rows are
+         * written according to the bytes per row of the planes of the destination.
+         *
+         * @param destination the pixel buffer owned by the caller. Defines the output image format, its sizes
+         * must be equal to the sizes of the output image
+         * @param callback calling with the destination, or nullptr if the image can not be written into it
+         *
+         * @example get_image(my_encoder_surface, [](pixel_buffer_sptr image){})
+         */
+        virtual void get_image(pixel_buffer_sptr destination, oep_pixel_buffer_ready_cb callback) = 0;
+
         /**
          * Returns the texture id of the texture used to render a frame. Can be used
          * to render with another context, if the OGL context sharing is enabled.
@@ -78,6 +108,26 @@ namespace bnb::oep::interfaces
          * @example get_texture([](std::optional<void*> texture_id){})
          */
         virtual void get_texture(oep_texture_ready_cb callback) = 0;
+
+        /**
+         * Returns the timings of the current frame. The readback and conversion stages are updated
+         * by get_image(), the callback and total stages are only known after the return from the callback.
+         *
+         * @return timings of the stages of the current frame
+         *
+         * @example get_frame_timings().get(frame_stage::draw)
+         */
+        virtual const frame_timings& get_frame_timings() = 0;
+
+        /**
+         * Set the timings of the frame which is passed to the callback.
+         * Called by offscreen effect player.
+         *
+         * @param timings timings of the stages measured before the callback
+         *
+         * @example set_frame_timings(my_timings)
+         */
+        virtual void set_frame_timings(const frame_timings& timings) = 0;
     }; /* class image_processing_result   INTERFACE */
 
 } /* namespace bnb::oep::interfaces */
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 #include <interfaces/effect_player.hpp>
 #include <interfaces/offscreen_render_target.hpp>
 #include <interfaces/image_processing_result.hpp>
+#include <interfaces/frame_timings.hpp>
 
 namespace bnb::oep::interfaces
 {
@@ -16,8 +18,79 @@ using oep_image_process_cb = std::function<void(image_processing_result_sptr)>;
 namespace bnb::oep::interfaces
 {
 
+    /* Defines what process_image_async() does when frames come faster than they are processed.
+     * The queue depth is the number of frames accepted but not yet processed, see set_backpressure_policy() */
+    enum class backpressure_policy : int32_t
+    {
+        latest_wins,    /* frames beyond the queue depth are rejected (process_image_async() returns false), only the newest
+                         * queued frame is rendered, the callbacks of the older ones are called with nullptr. Default policy */
+        drop_oldest,    /* every frame is accepted, at most 'queue depth' frames are waiting. When the queue is full, the oldest
+                         * waiting frame is dropped by process_image_async(): its image is released and its callback is called
+                         * with nullptr on the calling thread */
+        block_producer, /* process_image_async() blocks the calling thread while the queue is full, no frames are dropped */
+        lossless_fifo   /* every frame is accepted and processed in order, the queue depth is not used. Only the frames
+                         * beyond offscreen_effect_player::frame_queue_depth_max waiting ones are rejected */
+    }; /* enum class backpressure_policy */
+
+    /* Defines how the frames passed to process_image_async() are scheduled, see set_processing_mode() */
+    enum class processing_mode : int32_t
+    {
+        realtime,   /* the frames are processed according to the backpressure policy and the pipeline depth. Default mode */
+        offline     /* every frame is processed in order, process_image_async() blocks instead of rejecting the frame,
+                     * and several frames are kept in the pipeline to keep the GPU busy. Use flush() to wait for the last frames */
+    }; /* enum class processing_mode */
+
+    /* Reasons why a frame passed to process_image_async() was not processed */
+    enum class frame_drop_reason : int32_t
+    {
+        queue_full,     /* rejected by process_image_async() because of the backpressure policy */
+        outdated,       /* replaced by the newer frames according to the backpressure policy */
+        result_locked,  /* all the image processing results of the pool were locked, see set_result_pool_size() */
+        stopped,        /* the effect player was paused or stopped */
+        destroying,     /* the offscreen effect player was being destroyed */
+        count
+    }; /* enum class frame_drop_reason */
+
+    /* Runtime statistics of the offscreen effect player, see get_stats() */
+    struct offscreen_effect_player_stats
+    {
+        /* number of the calls of process_image_async() */
+        uint64_t submitted{0};
+        /* number of the frames passed to the callbacks with the image processing result */
+        uint64_t processed{0};
+        /* number of the dropped frames by the reason */
+        std::array<uint64_t, static_cast<size_t>(frame_drop_reason::count)> dropped{};
+        /* number of the accepted frames waiting for processing */
+        uint32_t queue_depth{0};
+        /* number of the image processing results locked by the consumers when the last frame was rendered */
+        uint32_t results_locked{0};
+        /* end-to-end latency from process_image_async() to the return from the callback */
+        latency_histogram_snapshot latency;
+
+        uint64_t get_dropped(frame_drop_reason reason) const
+        {
+            return dropped[static_cast<size_t>(reason)];
+        }
+    }; /* struct offscreen_effect_player_stats */
+
     class offscreen_effect_player
     {
+    public:
+        /* each frame is rendered, postprocessed and passed to the callback before the next one is started */
+        static constexpr int32_t pipeline_depth_low_latency = 1;
+        /* the next frames are rendered while the previous ones are waiting to be read back */
+        static constexpr int32_t pipeline_depth_throughput = 3;
+        /* the maximum supported pipeline depth */
+        static constexpr int32_t pipeline_depth_max = 4;
+        /* the default queue depth of the backpressure policy */
+        static constexpr int32_t frame_queue_depth_default = 5;
+        /* the maximum number of the frames waiting for processing with any backpressure policy */
+        static constexpr int32_t frame_queue_depth_max = 128;
+        /* the default number of the image processing results, no result may be kept locked after the callback */
+        static constexpr int32_t result_pool_size_default = 1;
+        /* the maximum number of the image processing results */
+        static constexpr int32_t result_pool_size_max = 8;
+
     public:
         /**
          * Create the offscreen effect player
@@ -44,11 +117,33 @@ namespace bnb::oep::interfaces
          * @param require_mirroring require mirroring for effect player
          * @param callback calling when frame will be processed, containing pointer of pixel_buffer for get bytes
          * @param target_orientation image orientation for postprocessing
+         * @param prefetch_formats formats which will be requested via image_processing_result::get_image(). The conversion
+         * and the asynchronous readback of them are started right after the rendering, so get_image() returns the already
+         * transferred image. Without them the format requested for the previous frame is prefetched
          *
-         * @example process_image_async(my_input_image, rotation::deg0, true, [](image_processing_result_sptr sptr){}, rotation::deg180)
-         * @return false if the frame is rejected because of too many items in the internal queue of frames, otherwise true
+         * @example process_image_async(my_input_image, rotation::deg0, true, [](image_processing_result_sptr sptr){}, rotation::deg180, {image_format::nv12_bt709_video})
+         * @return false if the frame is rejected because of too many items in the internal queue of frames
+         * (see backpressure_policy) or the offscreen effect player is destroying, otherwise true
          */
-        virtual bool process_image_async(pixel_buffer_sptr image, rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::optional<rotation> target_orientation) = 0;
+        virtual bool process_image_async(pixel_buffer_sptr image, rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::optional<rotation> target_orientation, const std::vector<image_format>& prefetch_formats = {}) = 0;
+
+        /**
+         * The same as process_image_async(), but the frame is rendered once and converted
+         * to all the outputs right after the rendering, e.g. the RGBA preview and the NV12 image for the encoder
+         * of another orientation and size. The outputs are read via image_processing_result::get_image(const output_spec&, ...)
+         *
+         * @param image the passed instance of the pixel_buffer class provides the access to the image byte data
+         * @param input_rotation image orientation for effect player
+         * @param require_mirroring require mirroring for effect player
+         * @param callback calling when frame will be processed, containing pointer of pixel_buffer for get bytes
+         * @param outputs formats, orientations and sizes of the output images. The orientation of the first output is used
+         * for postprocessing, i.e. for get_texture() and the other methods of image_processing_result
+         *
+         * @example process_image_outputs_async(my_input_image, rotation::deg0, true, [](image_processing_result_sptr sptr){}, {{image_format::bpc8_rgba, rotation::deg0}, {image_format::nv12_bt709_video, rotation::deg90, 1080, 1920}})
+         * @return false if the frame is rejected because of too many items in the internal queue of frames
+         * (see backpressure_policy) or the offscreen effect player is destroying, otherwise true
+         */
+        virtual bool process_image_outputs_async(pixel_buffer_sptr image, rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::vector<output_spec> outputs) = 0;
 
         /**
          * Notify about rendering surface being resized.
@@ -62,7 +157,71 @@ namespace bnb::oep::interfaces
         virtual void surface_changed(int32_t width, int32_t height) = 0;
 
         /**
-         * Load and activate effect async. May be called from any thread
+         * Set the number of frames that may be in processing at the same time. With the depth 1 (low latency)
+         * the callback of the frame is called before the next frame is rendered. With the depth N the callback
+         * of the frame is delayed until the next N-1 frames are rendered, so the GPU renders the next frame while
+         * the previous one is being read back. The frames kept in the pipeline are delivered as soon as the render thread
+         * has no next frame to process, so the last frame of a paused stream is not held. May be called from any thread
+         *
+         * @param depth number of frames in the pipeline in range [1..pipeline_depth_max],
+         * see pipeline_depth_low_latency (default) and pipeline_depth_throughput
+         *
+         * @example set_pipeline_depth(offscreen_effect_player::pipeline_depth_throughput)
+         */
+        virtual void set_pipeline_depth(int32_t depth) = 0;
+
+        /**
+         * Set the number of the image processing results passed to the callbacks. Each result reads its own
+         * render buffer, so the consumers may keep up to size-1 results locked after the return from the callback,
+         * e.g. the encoder holds the frame for a few milliseconds, while the next frames are rendered into the other
+         * buffers. The frame is dropped with frame_drop_reason::result_locked only if all the results are locked.
+         * The pool takes 'pipeline depth' + size - 1 render buffers. If the render target has fewer render buffers,
+         * see offscreen_render_target::set_buffer_count(), the pipeline depth and the size are reduced to fit them.
+         * May be called from any thread
+         *
+         * @param size number of the results in range [1..result_pool_size_max], result_pool_size_default by default
+         *
+         * @example set_result_pool_size(3)
+         */
+        virtual void set_result_pool_size(int32_t size) = 0;
+
+        /**
+         * Set the behavior of process_image_async() when the frames come faster than they are processed.
+         * May be called from any thread, the policy is applied to the frames already in the queue as well
+         *
+         * @param policy backpressure policy, backpressure_policy::latest_wins by default
+         * @param queue_depth maximum number of the frames waiting for processing in range [1..frame_queue_depth_max].
+         * Ignored by backpressure_policy::lossless_fifo. frame_queue_depth_default by default
+         *
+         * @example set_backpressure_policy(backpressure_policy::drop_oldest, 2)
+         */
+        virtual void set_backpressure_policy(backpressure_policy policy, int32_t queue_depth) = 0;
+
+        /**
+         * Set the processing mode. In processing_mode::offline the backpressure policy is treated as
+         * backpressure_policy::block_producer with the configured queue depth and the pipeline depth is set
+         * to pipeline_depth_throughput, in processing_mode::realtime the pipeline depth is set to
+         * pipeline_depth_low_latency. Call set_pipeline_depth() afterwards to override it. May be called from any thread
+         *
+         * @param mode processing mode, processing_mode::realtime by default
+         *
+         * @example set_processing_mode(processing_mode::offline)
+         */
+        virtual void set_processing_mode(processing_mode mode) = 0;
+
+        /**
+         * Block the calling thread until all the frames passed to process_image_async() before the call
+         * are processed and their callbacks are called, including the frames kept in the pipeline.
+         * Must not be called from the callbacks of the frames
+         *
+         * @example flush()
+         */
+        virtual void flush() = 0;
+
+        /**
+         * Load and activate effect async. May be called from any thread.
+         * The effect is loaded before the next frame in the order of the calls of load_effect(), call_js_method()
+         * and eval_js(), so the JS calls made after load_effect() are applied to the loaded effect
          *
          * @param effect_path Path to directory of effect
          *
@@ -99,7 +258,8 @@ namespace bnb::oep::interfaces
         virtual void stop() = 0;
 
         /**
-         * Call js method defined in config.js file of active effect
+         * Call js method defined in config.js file of active effect.
+         * The call is executed before the next frame, ahead of the frames waiting in the queue
          *
          * @param method JS function name. Member functions are not supported.
          * @param param function arguments as JSON string.
@@ -116,6 +276,59 @@ namespace bnb::oep::interfaces
          * @example eval_js("Skin.softening(1)", [](const std::string&){ DO SOMETHING })
          */
         virtual void eval_js(const std::string& script, oep_eval_js_result_cb result_callback) = 0;
+
+        /**
+         * Enable or disable coalescing of the JS calls. When enabled, the pending calls of call_js_method() with
+         * the same method are collapsed, only the last parameters are passed to the effect. All the pending calls
+         * of call_js_method() and eval_js() are executed in one batch right before drawing of the next frame,
+         * or as soon as the render thread is idle. Disabled by default. May be called from any thread
+         *
+         * @param enabled true to enable coalescing
+         *
+         * @example set_js_calls_coalescing(true)
+         */
+        virtual void set_js_calls_coalescing(bool enabled) = 0;
+
+        /**
+         * Returns the distribution of the durations of the stage over all the frames passed to the callbacks.
+         * The timings of a single frame are available via image_processing_result::get_frame_timings().
+         * May be called from any thread
+         *
+         * @param stage stage of the frame processing
+         *
+         * @return aggregated durations of the stage
+         *
+         * @example get_stage_histogram(frame_stage::draw).p95_ns
+         */
+        virtual latency_histogram_snapshot get_stage_histogram(frame_stage stage) = 0;
+
+        /**
+         * Clear the statistics of the stages. May be called from any thread
+         *
+         * @example reset_stage_histograms()
+         */
+        virtual void reset_stage_histograms() = 0;
+
+        /**
+         * Enable or disable measuring of the GPU time of the effect rendering, the orientation, the
+         * YUV conversion and the pixel packing passes. The results are aggregated in the frame_stage::gpu_* stage histograms.
+         * Disabled by default. May be called from any thread
+         *
+         * @param enabled true to measure the GPU time
+         *
+         * @example set_gpu_timers_enabled(true)
+         */
+        virtual void set_gpu_timers_enabled(bool enabled) = 0;
+
+        /**
+         * Returns the counters of the frames and the end-to-end latency. Lock free, may be called from any thread.
+         * The latency is reset by reset_stage_histograms()
+         *
+         * @return current statistics
+         *
+         * @example get_stats().get_dropped(frame_drop_reason::queue_full)
+         */
+        virtual offscreen_effect_player_stats get_stats() = 0;
     }; /* class offscreen_effect_player     INTERFACE */
 
 } /* namespace bnb::oep::interfaces */
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <interfaces/image_format.hpp>
+#include <interfaces/output_spec.hpp>
+#include <interfaces/frame_timings.hpp>
 #include <interfaces/pixel_buffer.hpp>
 #include <interfaces/render_context.hpp>
+#include <new>
 
 namespace bnb::oep::interfaces
 {
@@ -11,6 +14,7 @@ namespace bnb::oep::interfaces
 
 using rendered_texture_t = void*;
 using offscreen_render_target_sptr = std::shared_ptr<bnb::oep::interfaces::offscreen_render_target>;
+using oep_gpu_timing_cb = std::function<void(bnb::oep::interfaces::frame_stage stage, int64_t duration_ns)>;
 
 namespace bnb::oep::interfaces
 {
@@ -78,6 +82,39 @@ namespace bnb::oep::interfaces
          */
         virtual void deactivate_context() = 0;
 
+        /**
+         * Set the number of render buffers. Each buffer is a separate set of textures for rendering
+         * and postprocessing, so the frames rendered into the other buffers stay available for reading
+         * while the next frame is rendering. Should be called with the active context.
+         * Called by offscreen effect player.
+         * The default implementation has the single render buffer, then the offscreen effect player
+         * reduces the pipeline depth and the result pool size to one.
+         *
+         * @param count number of render buffers, must be greater than zero
+         *
+         * @return the number of render buffers set, may be less than requested
+         *
+         * @example set_buffer_count(2)
+         */
+        virtual int32_t set_buffer_count(int32_t /* count */)
+        {
+            return 1;
+        }
+
+        /**
+         * Select the render buffer used by the following calls of prepare_rendering(), orient_image(),
+         * read_current_buffer() and get_current_buffer_texture().
+         * Called by offscreen effect player.
+         * The default implementation does nothing.
+         *
+         * @param index index of the render buffer, must be in range [0..count-1]
+         *
+         * @example set_current_buffer_index(1)
+         */
+        virtual void set_current_buffer_index(int32_t /* index */)
+        {
+        }
+
         /**
          * Preparing texture for effect_player
          * Called by offscreen effect player.
@@ -87,7 +124,8 @@ namespace bnb::oep::interfaces
         virtual void prepare_rendering() = 0;
 
         /**
-         * Orientates the image
+         * Orientates the image. The implementation may defer the orientation pass until the image
+         * is requested by read_current_buffer() or get_current_buffer_texture().
          * Called by offscreen effect player.
          *
          * @param orient output image orientation
@@ -96,6 +134,21 @@ namespace bnb::oep::interfaces
          */
         virtual void orient_image(rotation orient) = 0;
 
+        /**
+         * Start the conversion of the current buffer to the outputs and the asynchronous transfer of the pixel
+         * bytes, so the following read_current_buffer() with the output returns the already transferred image
+         * instead of waiting for the GPU. All the passes are submitted at once after the single rendering of the frame.
+         * Called by offscreen effect player after orient_image().
+         * The default implementation does nothing, the images are read on request.
+         *
+         * @param outputs outputs which will be requested by read_current_buffer()
+         *
+         * @example prefetch({{image_format::bpc8_rgba, rotation::deg0}, {image_format::nv12_bt709_video, rotation::deg90}})
+         */
+        virtual void prefetch(const std::vector<output_spec>& /* outputs */)
+        {
+        }
+
         /**
          * Reading current buffer of active texture.
          * The implementation must definitely support for reading format image_format::bpc8_rgba
@@ -105,12 +158,58 @@ namespace bnb::oep::interfaces
          *
          * @return pixel_buffer_sptr - the smart pointer to the instance of the pixel_buffer interface,
          * providing access to the output image byte data, or nullptr if the specified format is not supported.
-         * Must have support for format image_format::bpc8_rgba
+         * Must have support for format image_format::bpc8_rgba. The pixel data may point directly into the memory
+         * of the render target, so it must be treated as read only. The memory stays valid after deinit() until
+         * the pixel buffer is released, then it is freed on the releasing thread together with the rendering context
          *
          * @example read_current_buffer(image_format::bpc8_rgba)
          */
         virtual pixel_buffer_sptr read_current_buffer(image_format format) = 0;
 
+        /**
+         * Reading current buffer in the format, the orientation and the size of the output. The orientation may differ
+         * from the one passed to orient_image(), the image is converted from the same rendered frame. If the size
+         * differs from the size of the rendered image after the orientation, the image is resampled on the GPU
+         * by the filter of the output.
+         * Called by image_processing_result
+         * The default implementation reads the image by read_current_buffer(image_format), so in the orientation
+         * passed to orient_image(), and does not support the outputs of the other sizes.
+         *
+         * @param output requested output image format, orientation and size
+         *
+         * @return pixel_buffer_sptr - the same as of read_current_buffer(image_format), nullptr if the output is not supported
+         *
+         * @example read_current_buffer({image_format::nv12_bt709_video, rotation::deg90, 1080, 1920, resample_filter::lanczos})
+         */
+        virtual pixel_buffer_sptr read_current_buffer(const output_spec& output)
+        {
+            if (output.width != 0 || output.height != 0) {
+                return nullptr;
+            }
+            return read_current_buffer(output.format);
+        }
+
+        /**
+         * Reading current buffer of active texture directly into the memory provided by the caller, e.g.
+         * into the input surface of the encoder. The rows are written according to the bytes per row of
+         * the planes of the destination.
+         * Called by image_processing_result
+         * The default implementation returns false, then the image is read by read_current_buffer(image_format)
+         * and copied into the destination.
+         *
+         * @param destination the pixel buffer owned by the caller. Defines the output image format, its sizes
+         * must be equal to the sizes of the rendered image after the orientation
+         *
+         * @return true if the image is written into the destination, false if the format is not supported
+         * or the sizes of the destination differ
+         *
+         * @example read_current_buffer(my_encoder_surface)
+         */
+        virtual bool read_current_buffer(pixel_buffer_sptr /* destination */)
+        {
+            return false;
+        }
+
         /**
          * Get texture id used for rendering of frame
          * Called by offscreen effect player.
@@ -120,6 +219,81 @@ namespace bnb::oep::interfaces
          * @example get_current_buffer_texture()
          */
         virtual rendered_texture_t get_current_buffer_texture() = 0;
+
+        /**
+         * Enable or disable measuring of the GPU time of the rendering passes. Does nothing if the
+         * rendering API does not support timer queries. Should be called with the active context.
+         * Called by offscreen effect player.
+         * The default implementation does nothing.
+         *
+         * @param enabled true to measure the GPU time
+         *
+         * @example set_gpu_timers_enabled(true)
+         */
+        virtual void set_gpu_timers_enabled(bool /* enabled */)
+        {
+        }
+
+        /**
+         * Pass the GPU timings of the passes finished since the previous call to the callback.
+         * Never waits for the GPU, the results usually become available a few frames later.
+         * Should be called with the active context.
+         * Called by offscreen effect player.
+         * The default implementation does nothing.
+         *
+         * @param callback called for each finished pass with one of the frame_stage::gpu_* stages
+         *
+         * @example collect_gpu_timings([](frame_stage stage, int64_t duration_ns){})
+         */
+        virtual void collect_gpu_timings(const oep_gpu_timing_cb& /* callback */)
+        {
+        }
+
+        /**
+         * Allocate the memory for the output pixel data. The memory is taken from the pool of the render target
+         * and returns to it with the last reference, so in the steady state the output does not allocate.
+         * May be called from any thread.
+         * Called by image_processing_result
+         * The default implementation allocates the memory on each call without the pool.
+         *
+         * @param size the minimum size of the memory in bytes
+         *
+         * @return the memory aligned to at least 64 bytes
+         *
+         * @example allocate_buffer(1920 * 1080 * 4)
+         */
+        virtual std::shared_ptr<uint8_t> allocate_buffer(size_t size)
+        {
+            constexpr std::align_val_t alignment{64};
+            auto data = static_cast<uint8_t*>(::operator new[](size, alignment));
+            return std::shared_ptr<uint8_t>(data, [alignment](uint8_t* ptr) { ::operator delete[](ptr, alignment); });
+        }
+
+        /**
+         * Limit the memory kept by the pool of the output pixel data. The released memory above the limits is
+         * freed instead of returning to the pool. May be called from any thread.
+         * The default implementation does nothing.
+         *
+         * @param max_cached_bytes the maximum total size of the memory waiting in the pool
+         * @param max_buffers_per_size the maximum number of the buffers of each size class waiting in the pool
+         *
+         * @example set_buffer_pool_limits(64 * 1024 * 1024, 8)
+         */
+        virtual void set_buffer_pool_limits(size_t /* max_cached_bytes */, size_t /* max_buffers_per_size */)
+        {
+        }
+
+        /**
+         * Free the memory waiting in the pool of the output pixel data, e.g. on low memory warnings.
+         * Called on surface_changed(), because the buffers of the previous size are not used anymore.
+         * May be called from any thread.
+         * The default implementation does nothing.
+         *
+         * @example trim_buffer_pool()
+         */
+        virtual void trim_buffer_pool()
+        {
+        }
     }; /* class offscreen_render_target         INTERFACE */
 
 } /* namespace bnb::oep::interfaces */
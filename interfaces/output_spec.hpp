@@ -0,0 +1,38 @@
+#pragma once
+
+#include <interfaces/image_format.hpp>
+
+namespace bnb::oep::interfaces
+{
+
+    /* Filter used to resample the image when the size of the output differs from the size of the rendered image */
+    enum class resample_filter : int32_t
+    {
+        nearest,    /* the nearest pixel, the fastest, aliasing on downscaling */
+        bilinear,   /* the triangle filter, widened on downscaling to average all the covered pixels. Default filter */
+        bicubic,    /* the Catmull-Rom spline, sharper than bilinear */
+        lanczos     /* the Lanczos filter with three lobes, the sharpest, the most expensive */
+    }; /* enum class resample_filter */
+
+    /* Description of one of the output images produced from the single rendered frame */
+    struct output_spec
+    {
+        image_format format{image_format::bpc8_rgba};
+        rotation orientation{rotation::deg0};
+        /* sizes of the output image after the orientation, zero to use the size of the rendered image */
+        int32_t width{0};
+        int32_t height{0};
+        resample_filter filter{resample_filter::bilinear};
+
+        bool operator==(const output_spec& other) const
+        {
+            return format == other.format && orientation == other.orientation && width == other.width && height == other.height && filter == other.filter;
+        }
+
+        bool operator!=(const output_spec& other) const
+        {
+            return !(*this == other);
+        }
+    }; /* struct output_spec */
+
+} /* namespace bnb::oep::interfaces */
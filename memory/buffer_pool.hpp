@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace bnb::oep::memory
+{
+
+    /* Pool of the memory blocks for the pixel data. The sizes are rounded up to the size classes, four per power
+     * of two, so the frames of the same size always reuse the blocks of one class. The block returns to the pool
+     * with the last reference to the shared pointer, which may happen on any thread. The control block of the
+     * shared pointer is stored in the header of the block, so in the steady state acquire() never allocates.
+     * The pool should be owned by the shared pointer, blocks released after its destruction are freed */
+    class buffer_pool : public std::enable_shared_from_this<buffer_pool>
+    {
+    public:
+        static constexpr size_t default_max_cached_bytes = 64 * 1024 * 1024;
+        static constexpr size_t default_max_blocks_per_class = 8;
+        static constexpr size_t min_block_capacity = 4096;
+        static constexpr size_t block_alignment = 64;
+
+        struct stats
+        {
+            uint64_t hits{0};         /* acquire() calls served by the cached blocks */
+            uint64_t misses{0};       /* acquire() calls which allocated the new blocks */
+            size_t cached_bytes{0};   /* capacity of the blocks waiting in the pool */
+            size_t acquired_bytes{0}; /* capacity of the blocks referenced by the users */
+        };
+
+    public:
+        buffer_pool() = default;
+
+        buffer_pool(const buffer_pool&) = delete;
+        buffer_pool& operator=(const buffer_pool&) = delete;
+
+        ~buffer_pool()
+        {
+            for (auto& free_list : m_free_lists) {
+                for (auto* b : free_list.second) {
+                    destroy_block(b);
+                }
+            }
+        }
+
+        /* returns the memory of at least size bytes aligned to block_alignment */
+        std::shared_ptr<uint8_t> acquire(size_t size)
+        {
+            size_t capacity = round_capacity(size);
+            block* b{nullptr};
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto& free_list = m_free_lists[capacity];
+                if (!free_list.empty()) {
+                    b = free_list.back();
+                    free_list.pop_back();
+                    m_stats.cached_bytes -= capacity;
+                    ++m_stats.hits;
+                } else {
+                    /* so returning the blocks does not allocate */
+                    free_list.reserve(m_max_blocks_per_class);
+                    ++m_stats.misses;
+                }
+                m_stats.acquired_bytes += capacity;
+            }
+            if (b == nullptr) {
+                try {
+                    b = create_block(capacity);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stats.acquired_bytes -= capacity;
+                    throw;
+                }
+            }
+            try {
+                return std::shared_ptr<uint8_t>(block_data(b), [](uint8_t*) {}, header_allocator<uint8_t>(b));
+            } catch (...) {
+                recycle(b);
+                throw;
+            }
+        }
+
+        /* the blocks are freed instead of returning to the pool if the limits are exceeded */
+        void set_limits(size_t max_cached_bytes, size_t max_blocks_per_class)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_max_cached_bytes = max_cached_bytes;
+            m_max_blocks_per_class = max_blocks_per_class;
+            trim_locked(m_max_cached_bytes, m_max_blocks_per_class);
+        }
+
+        /* frees the cached blocks until their total capacity is not greater than max_cached_bytes */
+        void trim(size_t max_cached_bytes = 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            trim_locked(max_cached_bytes, m_max_blocks_per_class);
+        }
+
+        stats get_stats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
+        }
+
+        static size_t round_capacity(size_t size)
+        {
+            if (size <= min_block_capacity) {
+                return min_block_capacity;
+            }
+            int32_t high_bit = 0;
+            for (size_t v = size - 1; v > 1; v >>= 1) {
+                ++high_bit;
+            }
+            size_t step = size_t(1) << (high_bit - 2);
+            return (size + step - 1) & ~(step - 1);
+        }
+
+    private:
+        /* room for the control block of the shared pointer with the empty deleter and the allocator */
+        static constexpr size_t control_block_size = 64;
+
+        struct block
+        {
+            size_t capacity{0};
+            std::weak_ptr<buffer_pool> pool;
+            alignas(std::max_align_t) unsigned char control_block[control_block_size];
+        };
+
+        static constexpr size_t data_offset = (sizeof(block) + block_alignment - 1) & ~(block_alignment - 1);
+
+        /* places the control block of the shared pointer in the header of the block and returns the block
+        to the pool when the control block is deallocated, which is the last access of the shared pointer */
+        template<class T>
+        struct header_allocator
+        {
+            using value_type = T;
+
+            explicit header_allocator(block* b) noexcept
+                : owner(b)
+            {
+            }
+
+            template<class U>
+            header_allocator(const header_allocator<U>& other) noexcept
+                : owner(other.owner)
+            {
+            }
+
+            T* allocate(size_t n)
+            {
+                if (n * sizeof(T) <= control_block_size && alignof(T) <= alignof(std::max_align_t)) {
+                    return reinterpret_cast<T*>(owner->control_block);
+                }
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+
+            /* called once for the control block, so the block returns to the pool even if the control block did not fit */
+            void deallocate(T* p, size_t) noexcept
+            {
+                if (reinterpret_cast<unsigned char*>(p) != owner->control_block) {
+                    ::operator delete(p);
+                }
+                if (auto pool = owner->pool.lock()) {
+                    pool->recycle(owner);
+                } else {
+                    destroy_block(owner);
+                }
+            }
+
+            template<class U>
+            bool operator==(const header_allocator<U>& other) const noexcept
+            {
+                return owner == other.owner;
+            }
+
+            template<class U>
+            bool operator!=(const header_allocator<U>& other) const noexcept
+            {
+                return owner != other.owner;
+            }
+
+            block* owner;
+        };
+
+    private:
+        block* create_block(size_t capacity)
+        {
+            void* memory = ::operator new(data_offset + capacity, std::align_val_t(block_alignment));
+            auto* b = new (memory) block();
+            b->capacity = capacity;
+            b->pool = weak_from_this();
+            return b;
+        }
+
+        static void destroy_block(block* b) noexcept
+        {
+            b->~block();
+            ::operator delete(static_cast<void*>(b), std::align_val_t(block_alignment));
+        }
+
+        static uint8_t* block_data(block* b) noexcept
+        {
+            return reinterpret_cast<uint8_t*>(b) + data_offset;
+        }
+
+        void recycle(block* b) noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.acquired_bytes -= b->capacity;
+                auto it = m_free_lists.find(b->capacity);
+                if (it != m_free_lists.end() && it->second.size() < it->second.capacity()
+                    && it->second.size() < m_max_blocks_per_class && m_stats.cached_bytes + b->capacity <= m_max_cached_bytes) {
+                    it->second.push_back(b);
+                    m_stats.cached_bytes += b->capacity;
+                    return;
+                }
+            }
+            destroy_block(b);
+        }
+
+        void trim_locked(size_t max_cached_bytes, size_t max_blocks_per_class)
+        {
+            for (auto it = m_free_lists.begin(); it != m_free_lists.end();) {
+                auto& free_list = it->second;
+                while (!free_list.empty() && (m_stats.cached_bytes > max_cached_bytes || free_list.size() > max_blocks_per_class)) {
+                    m_stats.cached_bytes -= free_list.back()->capacity;
+                    destroy_block(free_list.back());
+                    free_list.pop_back();
+                }
+                /* the size classes of the previous frame sizes are not kept forever */
+                if (free_list.empty() && max_cached_bytes == 0) {
+                    it = m_free_lists.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<size_t, std::vector<block*>> m_free_lists;
+        size_t m_max_cached_bytes{default_max_cached_bytes};
+        size_t m_max_blocks_per_class{default_max_blocks_per_class};
+        stats m_stats;
+    }; /* class buffer_pool */
+
+} /* namespace bnb::oep::memory */
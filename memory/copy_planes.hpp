@@ -0,0 +1,46 @@
+#pragma once
+
+#include <interfaces/pixel_buffer.hpp>
+#include <cstring>
+
+namespace bnb::oep::memory
+{
+
+    /* Copy the planes of the image into the planes of the destination of the same format row by row,
+     * so each of the images may have its own bytes per row. The source may be larger than the destination,
+     * e.g. have the width aligned by the converter, only the size of the destination is copied.
+     * Returns false and copies nothing if the images are not compatible */
+    inline bool copy_planes(interfaces::pixel_buffer& src, interfaces::pixel_buffer& dst)
+    {
+        if (src.get_image_format() != dst.get_image_format() || src.get_plane_count() != dst.get_plane_count()) {
+            return false;
+        }
+        for (int32_t p = 0; p < dst.get_plane_count(); ++p) {
+            size_t row_size = static_cast<size_t>(dst.get_width_of_plane(p)) * dst.get_bytes_per_pixel_of_plane(p);
+            if (src.get_width_of_plane(p) < dst.get_width_of_plane(p) || src.get_height_of_plane(p) < dst.get_height_of_plane(p)
+                || static_cast<size_t>(dst.get_bytes_per_row_of_plane(p)) < row_size || dst.get_base_sptr_of_plane(p) == nullptr) {
+                return false;
+            }
+        }
+
+        for (int32_t p = 0; p < dst.get_plane_count(); ++p) {
+            const uint8_t* src_row = src.get_base_sptr_of_plane(p).get();
+            uint8_t* dst_row = dst.get_base_sptr_of_plane(p).get();
+            size_t src_stride = static_cast<size_t>(src.get_bytes_per_row_of_plane(p));
+            size_t dst_stride = static_cast<size_t>(dst.get_bytes_per_row_of_plane(p));
+            size_t row_size = static_cast<size_t>(dst.get_width_of_plane(p)) * dst.get_bytes_per_pixel_of_plane(p);
+            int32_t height = dst.get_height_of_plane(p);
+            if (src_stride == dst_stride && src_stride == row_size) {
+                std::memcpy(dst_row, src_row, row_size * height);
+                continue;
+            }
+            for (int32_t y = 0; y < height; ++y) {
+                std::memcpy(dst_row, src_row, row_size);
+                src_row += src_stride;
+                dst_row += dst_stride;
+            }
+        }
+        return true;
+    }
+
+} /* namespace bnb::oep::memory */
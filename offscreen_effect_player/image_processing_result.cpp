@@ -1,5 +1,8 @@
 #include "image_processing_result.hpp"
 
+#include <profiling/clock.hpp>
+#include <profiling/trace.hpp>
+#include <memory/copy_planes.hpp>
 #include <iostream>
 #include <libyuv.h>
 #include <vector>
@@ -8,14 +11,15 @@ namespace bnb::oep
 {
 
     /* interfaces::image_process::create */
-    image_processing_result_sptr bnb::oep::interfaces::image_processing_result::create(offscreen_render_target_sptr ort)
+    image_processing_result_sptr bnb::oep::interfaces::image_processing_result::create(offscreen_render_target_sptr ort, int32_t buffer_index)
     {
-        return image_processing_result_sptr(new bnb::oep::image_processing_result(ort));
+        return image_processing_result_sptr(new bnb::oep::image_processing_result(ort, buffer_index));
     }
 
     /* image_processing_result::image_processing_result */
-    image_processing_result::image_processing_result(offscreen_render_target_sptr ort)
+    image_processing_result::image_processing_result(offscreen_render_target_sptr ort, int32_t buffer_index)
         : m_ort(ort)
+        , m_buffer_index(buffer_index)
     {
     }
 
@@ -33,9 +37,11 @@ namespace bnb::oep
     /* image_processing_result::unlock */
     void image_processing_result::unlock()
     {
-        if (m_lock_count > 0) {
-            m_lock_count--;
-            return;
+        auto count = m_lock_count.load();
+        while (count > 0) {
+            if (m_lock_count.compare_exchange_weak(count, count - 1)) {
+                return;
+            }
         }
         throw std::runtime_error("image_processing_result already unlocked");
     }
@@ -54,77 +60,206 @@ namespace bnb::oep
             callback(nullptr);
             return;
         }
+        BNB_OEP_TRACE_SCOPE("ipr", "get_image");
+        m_ort->set_current_buffer_index(m_buffer_index);
+
+        pixel_buffer_sptr image = read_image(format, nullptr);
+        if (image == nullptr) {
+            std::cout << "[WARNING] Conversion to '" << image_format_to_cstr(format) << "' format is not implemented." << std::endl;
+        }
+        callback(image);
+    }
+
+    /* image_processing_result::get_image */
+    void image_processing_result::get_image(const bnb::oep::interfaces::output_spec& output, oep_pixel_buffer_ready_cb callback)
+    {
+        if (!is_locked()) {
+            std::cout << "[WARNING] The 'image processing result' must be locked" << std::endl;
+            callback(nullptr);
+            return;
+        }
+        BNB_OEP_TRACE_SCOPE("ipr", "get_image_output");
+        m_ort->set_current_buffer_index(m_buffer_index);
+
+        pixel_buffer_sptr image = read_image(output.format, nullptr, output);
+        if (image == nullptr) {
+            std::cout << "[WARNING] Conversion to '" << image_format_to_cstr(output.format) << "' format is not implemented." << std::endl;
+        }
+        callback(image);
+    }
+
+    /* image_processing_result::get_image */
+    void image_processing_result::get_image(pixel_buffer_sptr destination, oep_pixel_buffer_ready_cb callback)
+    {
+        if (!is_locked()) {
+            std::cout << "[WARNING] The 'image processing result' must be locked" << std::endl;
+            callback(nullptr);
+            return;
+        }
+        if (destination == nullptr) {
+            callback(nullptr);
+            return;
+        }
+        BNB_OEP_TRACE_SCOPE("ipr", "get_image_into");
+        m_ort->set_current_buffer_index(m_buffer_index);
+
+        using bnb::oep::interfaces::frame_stage;
+        using bnb::oep::profiling::now_ns;
 
+        /* the offscreen_render_target writes the image straight into the destination without the intermediate copy */
+        auto readback_start = now_ns();
+        bool written = m_ort->read_current_buffer(destination);
+        m_frame_timings.add(frame_stage::readback, now_ns() - readback_start);
+        if (written) {
+            callback(destination);
+            return;
+        }
+
+        /* the image is read or converted by the same rules as without the destination. The software conversion
+        writes into the destination directly, otherwise the read image is copied into the destination */
+        auto format = destination->get_image_format();
+        pixel_buffer_sptr image = read_image(format, destination);
+        if (image == nullptr) {
+            std::cout << "[WARNING] Conversion to '" << image_format_to_cstr(format) << "' format is not implemented." << std::endl;
+            callback(nullptr);
+            return;
+        }
+        if (image != destination) {
+            auto copy_start = now_ns();
+            bool copied = image->get_height() == destination->get_height() && bnb::oep::memory::copy_planes(*image, *destination);
+            m_frame_timings.add(frame_stage::conversion, now_ns() - copy_start);
+            if (!copied) {
+                std::cout << "[WARNING] The image can not be written into the destination pixel buffer" << std::endl;
+                callback(nullptr);
+                return;
+            }
+        }
+        callback(destination);
+    }
+
+    /* image_processing_result::read_image */
+    pixel_buffer_sptr image_processing_result::read_image(bnb::oep::interfaces::image_format format, pixel_buffer_sptr destination, const std::optional<bnb::oep::interfaces::output_spec>& output)
+    {
         using ns = bnb::oep::interfaces::image_format;
+        using bnb::oep::interfaces::frame_stage;
+        using bnb::oep::profiling::now_ns;
+
+        auto read_current_buffer = [this, &output](ns read_format) {
+            if (!output.has_value()) {
+                return m_ort->read_current_buffer(read_format);
+            }
+            auto read_output = *output;
+            read_output.format = read_format;
+            return m_ort->read_current_buffer(read_output);
+        };
 
         /* Since offscreen_render_target may not be able to read some implementations of
         formats, we first read the format that is needed */
         /* In the current implementation of the offscreen_render_target - has hardware support for
-        converting to i420. It's better because works faster. */
-        pixel_buffer_sptr image = m_ort->read_current_buffer(format);
+        converting to i420 and nv12. It's better because works faster. */
+        auto readback_start = now_ns();
+        pixel_buffer_sptr image = read_current_buffer(format);
+        m_frame_timings.add(frame_stage::readback, now_ns() - readback_start);
 
         /* If image != nullptr then we got the image with needed image_format and returns it */
         if (image != nullptr) {
-            callback(image);
-            return;
+            return image;
         }
 
         /* Code below assumes software conversion to needed format of the image */
 
-        /* In the current implementation offscreen_render_target provide convertation to i420,
+        /* Other implementations of offscreen_render_target may provide convertation to i420,
         but not nv12. i420 and nv12 have similar conversion alhorithms, differs only in
         the method of writing the pixel bytes. Code below converts from i420 to nv12 */
+        readback_start = now_ns();
         switch (format) {
             case ns::nv12_bt601_full:
-                image = m_ort->read_current_buffer(ns::i420_bt601_full);
+                image = read_current_buffer(ns::i420_bt601_full);
                 break;
             case ns::nv12_bt601_video:
-                image = m_ort->read_current_buffer(ns::i420_bt601_video);
+                image = read_current_buffer(ns::i420_bt601_video);
                 break;
             case ns::nv12_bt709_full:
-                image = m_ort->read_current_buffer(ns::i420_bt709_full);
+                image = read_current_buffer(ns::i420_bt709_full);
                 break;
             case ns::nv12_bt709_video:
-                image = m_ort->read_current_buffer(ns::i420_bt709_video);
+                image = read_current_buffer(ns::i420_bt709_video);
                 break;
             default:
                 break;
         }
+        m_frame_timings.add(frame_stage::readback, now_ns() - readback_start);
 
         if (image != nullptr) {
             switch (format) {
                 case ns::nv12_bt601_full:
                 case ns::nv12_bt601_video:
                 case ns::nv12_bt709_full:
-                case ns::nv12_bt709_video:
-                    callback(convert_image_to_nv12(image, format));
-                    return;
+                case ns::nv12_bt709_video: {
+                    auto conversion_start = now_ns();
+                    BNB_OEP_TRACE_SCOPE("ipr", "convert_image_to_nv12");
+                    auto converted = convert_image_to_nv12(image, format, destination);
+                    m_frame_timings.add(frame_stage::conversion, now_ns() - conversion_start);
+                    return converted;
+                }
                 default:
                     break;
             }
         }
-
-        std::cout << "[WARNING] Conversion to '" << image_format_to_cstr(format) << "' format is not implemented." << std::endl;
-        callback(nullptr);
+        return nullptr;
     }
 
     /* image_processing_result::get_texture */
     void image_processing_result::get_texture(oep_texture_ready_cb callback)
     {
+        m_ort->set_current_buffer_index(m_buffer_index);
         callback(m_ort->get_current_buffer_texture());
     }
 
+    /* image_processing_result::get_frame_timings */
+    const bnb::oep::interfaces::frame_timings& image_processing_result::get_frame_timings()
+    {
+        return m_frame_timings;
+    }
+
+    /* image_processing_result::set_frame_timings */
+    void image_processing_result::set_frame_timings(const bnb::oep::interfaces::frame_timings& timings)
+    {
+        m_frame_timings = timings;
+    }
+
     /* image_processing_result::convert_image_to_nv12 */
-    pixel_buffer_sptr image_processing_result::convert_image_to_nv12(pixel_buffer_sptr image, bnb::oep::interfaces::image_format nv12_format)
+    pixel_buffer_sptr image_processing_result::convert_image_to_nv12(pixel_buffer_sptr image, bnb::oep::interfaces::image_format nv12_format, pixel_buffer_sptr destination)
     {
         /* The code below converts from i420 to nv12. If nv12_format is not format i420 then this code
         will be 'undefined behaviour' */
+        if (destination != nullptr) {
+            if (destination->get_height() != image->get_height() || destination->get_width() > image->get_width()) {
+                return nullptr;
+            }
+            libyuv::I420ToNV12(
+                image->get_base_sptr_of_plane(0).get(),
+                image->get_bytes_per_row_of_plane(0),
+                image->get_base_sptr_of_plane(1).get(),
+                image->get_bytes_per_row_of_plane(1),
+                image->get_base_sptr_of_plane(2).get(),
+                image->get_bytes_per_row_of_plane(2),
+                destination->get_base_sptr_of_plane(0).get(),
+                destination->get_bytes_per_row_of_plane(0),
+                destination->get_base_sptr_of_plane(1).get(),
+                destination->get_bytes_per_row_of_plane(1),
+                destination->get_width(),
+                destination->get_height());
+            return destination;
+        }
+
         using ns_pb = bnb::oep::interfaces::pixel_buffer;
         int32_t stride = image->get_width();
         size_t size = stride * image->get_height() + stride * image->get_height() / 2;
-        ns_pb::plane_sptr y_plane_data(new uint8_t[size]);
+        ns_pb::plane_sptr y_plane_data = m_ort->allocate_buffer(size);
         size_t y_plane_size = stride * image->get_height();
-        ns_pb::plane_sptr uv_plane_data(y_plane_data.get() + y_plane_size, [](uint8_t*) {});
+        /* the UV plane shares the ownership of the memory, so it is valid while any plane is referenced */
+        ns_pb::plane_sptr uv_plane_data(y_plane_data, y_plane_data.get() + y_plane_size);
         size_t uv_plane_size = stride * image->get_height() / 2;
 
         ns_pb::plane_data y_plane{y_plane_data, y_plane_size, stride};
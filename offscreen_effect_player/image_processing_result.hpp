@@ -1,6 +1,8 @@
 #pragma once
 
 #include <interfaces/image_processing_result.hpp>
+#include <atomic>
+#include <optional>
 
 namespace bnb::oep
 {
@@ -8,7 +10,7 @@ namespace bnb::oep
     class image_processing_result : public bnb::oep::interfaces::image_processing_result
     {
     public:
-        image_processing_result(offscreen_render_target_sptr ort);
+        image_processing_result(offscreen_render_target_sptr ort, int32_t buffer_index);
 
         ~image_processing_result();
 
@@ -20,17 +22,31 @@ namespace bnb::oep
 
         void get_image(bnb::oep::interfaces::image_format format, oep_pixel_buffer_ready_cb callback) override;
 
+        void get_image(const bnb::oep::interfaces::output_spec& output, oep_pixel_buffer_ready_cb callback) override;
+
+        void get_image(pixel_buffer_sptr destination, oep_pixel_buffer_ready_cb callback) override;
+
         void get_texture(oep_texture_ready_cb callback) override;
 
+        const bnb::oep::interfaces::frame_timings& get_frame_timings() override;
+
+        void set_frame_timings(const bnb::oep::interfaces::frame_timings& timings) override;
+
     private:
+        /* reads the image in the format, the software conversion writes into the destination if it is not nullptr.
+        Without the output the image is read in the orientation and the size of the frame */
+        pixel_buffer_sptr read_image(bnb::oep::interfaces::image_format format, pixel_buffer_sptr destination, const std::optional<bnb::oep::interfaces::output_spec>& output = std::nullopt);
         pixel_buffer_sptr convert_image_to_bpc8(pixel_buffer_sptr image, bnb::oep::interfaces::image_format bpc8_format);
-        pixel_buffer_sptr convert_image_to_nv12(pixel_buffer_sptr image, bnb::oep::interfaces::image_format nv12_format);
+        pixel_buffer_sptr convert_image_to_nv12(pixel_buffer_sptr image, bnb::oep::interfaces::image_format nv12_format, pixel_buffer_sptr destination);
         pixel_buffer_sptr convert_image_to_i420(pixel_buffer_sptr image, bnb::oep::interfaces::image_format i420_format);
         const char* image_format_to_cstr(bnb::oep::interfaces::image_format format);
 
     private:
         offscreen_render_target_sptr m_ort{nullptr};
-        int32_t m_lock_count{0};
+        int32_t m_buffer_index{0};
+        /* unlocked by the consumers which keep the result after the callback, so may be changed from any thread */
+        std::atomic<int32_t> m_lock_count{0};
+        bnb::oep::interfaces::frame_timings m_frame_timings;
     }; /* class image_processing_result */
 
 } /* namespace bnb::oep */
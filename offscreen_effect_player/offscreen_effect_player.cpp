@@ -1,5 +1,8 @@
 #include "offscreen_effect_player.hpp"
 
+#include <profiling/clock.hpp>
+#include <profiling/trace.hpp>
+#include <algorithm>
 #include <iostream>
 #include <thread>
 
@@ -16,11 +19,16 @@ namespace bnb::oep
     offscreen_effect_player::offscreen_effect_player(effect_player_sptr ep, offscreen_render_target_sptr ort, int32_t width, int32_t height)
         : m_ep(ep)
         , m_ort(ort)
-        , m_scheduler(1)
+        , m_scheduler()
     {
-        m_current_frame = bnb::oep::interfaces::image_processing_result::create(m_ort);
+        /* the render target has one render buffer initially, matching the default pipeline depth and pool size */
+        m_results.push_back({bnb::oep::interfaces::image_processing_result::create(m_ort, 0)});
+        m_gpu_timing_recorder = [this](interfaces::frame_stage stage, int64_t duration_ns) {
+            m_stage_histograms[static_cast<size_t>(stage)].record(duration_ns);
+        };
         // MacOS GLFW requires window creation on main thread, so it is assumed that we are on main thread.
         auto task = [this, width, height]() {
+            BNB_OEP_TRACE_SCOPE("oep", "init");
             render_thread_id = std::this_thread::get_id();
             m_ort->init(width, height);
             m_ort->activate_context();
@@ -29,10 +37,9 @@ namespace bnb::oep
             m_ort->deactivate_context();
         };
 
-        auto future = m_scheduler.enqueue(task);
         try {
             // Wait result of task since initialization of glad can cause exceptions if proceed without
-            future.get();
+            m_scheduler.enqueue_and_wait(lane::control, task);
         } catch (std::runtime_error& e) {
             std::cout << "[ERROR] Failed to initialize effect player: " << e.what() << std::endl;
             std::string s = "Failed to initialize effect player.\n";
@@ -47,85 +54,336 @@ namespace bnb::oep
         // Switches effect player to inactive state and deinitializes offscreen render target.
         // Must be performed on render thread.
         auto task = [this]() {
+            BNB_OEP_TRACE_SCOPE("oep", "destroy");
             m_ort->activate_context();
+            complete_frames_in_flight();
             m_ep->surface_destroyed();
             m_ort->deinit();
         };
         m_destroy = true;
-        m_scheduler.enqueue(task).get();
+        wake_blocked_producers();
+        /* the remaining tasks are executed before the deinitialization */
+        m_scheduler.stop(task);
     }
 
     /* offscreen_effect_player::process_image_async */
-    bool offscreen_effect_player::process_image_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring,  oep_image_process_cb callback, std::optional<bnb::oep::interfaces::rotation> target_orientation)
+    bool offscreen_effect_player::process_image_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring,  oep_image_process_cb callback, std::optional<bnb::oep::interfaces::rotation> target_orientation, const std::vector<bnb::oep::interfaces::image_format>& prefetch_formats)
     {
+        /* one bit per format, so the task does not capture the vector */
+        uint32_t prefetch_mask = 0;
+        for (auto format : prefetch_formats) {
+            prefetch_mask |= 1u << static_cast<uint32_t>(format);
+        }
+        /* set default orientation */
+        auto orientation = target_orientation.value_or(bnb::oep::interfaces::rotation::deg0);
+        return enqueue_frame(std::move(image), input_rotation, require_mirroring, std::move(callback), orientation, prefetch_mask, {});
+    }
+
+    /* offscreen_effect_player::process_image_outputs_async */
+    bool offscreen_effect_player::process_image_outputs_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::vector<bnb::oep::interfaces::output_spec> outputs)
+    {
+        /* the image_processing_result is oriented as the first output */
+        auto orientation = outputs.empty() ? bnb::oep::interfaces::rotation::deg0 : outputs.front().orientation;
+        return enqueue_frame(std::move(image), input_rotation, require_mirroring, std::move(callback), orientation, 0, std::move(outputs));
+    }
+
+    /* offscreen_effect_player::enqueue_frame */
+    bool offscreen_effect_player::enqueue_frame(pixel_buffer_sptr image, interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, interfaces::rotation target_orientation, uint32_t prefetch_mask, std::vector<interfaces::output_spec> outputs)
+    {
+        using bnb::oep::interfaces::frame_drop_reason;
+
+        ++m_submitted_frames;
         if (m_destroy) {
-            if (callback) {
-                callback(nullptr);
+            drop_frame(callback, frame_drop_reason::destroying);
+            return false;
+        }
+
+        /* the frame is rejected before the task is built, so no work is wasted on it */
+        if (!acquire_frame_queue_slot()) {
+            if (m_destroy) {
+                drop_frame(callback, frame_drop_reason::destroying);
+            } else {
+                /* the caller is notified by the return value */
+                ++m_dropped_frames[static_cast<size_t>(frame_drop_reason::queue_full)];
             }
             return false;
         }
+        queued_frame frame;
+        frame.image = std::move(image);
+        frame.callback = callback ? std::move(callback) : [](image_processing_result_sptr) {};
+        frame.outputs = std::move(outputs);
+        frame.input_rotation = input_rotation;
+        frame.target_orientation = target_orientation;
+        frame.require_mirroring = require_mirroring;
+        frame.prefetch_mask = prefetch_mask;
+        frame.frame_seq = ++m_last_frame_seq;
+        frame.enqueue_time = profiling::now_ns();
 
-        if (!target_orientation.has_value()) {
-            /* set default orientation */
-            target_orientation = bnb::oep::interfaces::rotation::deg0;
+        push_queued_frame(std::move(frame), get_effective_backpressure_policy() == interfaces::backpressure_policy::drop_oldest);
+        return true;
+    }
+
+    /* offscreen_effect_player::push_queued_frame */
+    void offscreen_effect_player::push_queued_frame(queued_frame&& frame, bool drop_oldest)
+    {
+        std::unique_lock<std::mutex> lock(m_queued_frames_mutex);
+        if (m_queued_frames.empty()) {
+            m_queued_frames.resize(static_cast<size_t>(frame_queue_depth_max));
         }
+        /* the other policies keep the number of the accepted frames within the ring, it is only full
+        if several producers have passed acquire_frame_queue_slot() at once */
+        auto depth = drop_oldest ? std::min(static_cast<size_t>(m_frame_queue_depth.load()), m_queued_frames.size()) : m_queued_frames.size();
+        while (m_queued_frames_count >= depth) {
+            {
+                /* the oldest frame and its image are released right away instead of waiting for the render thread */
+                auto oldest = take_queued_frame();
+                /* the callback may pass the next frame, so it is called without the lock */
+                lock.unlock();
+                drop_frame(oldest.callback, interfaces::frame_drop_reason::outdated);
+            }
+            release_frame_queue_slot();
+            lock.lock();
+        }
+        m_queued_frames[(m_queued_frames_head + m_queued_frames_count) % m_queued_frames.size()] = std::move(frame);
+        ++m_queued_frames_count;
 
-        constexpr int32_t incoming_frame_queue_task_max = 5;
-        if (m_incoming_frame_queue_task_count >= incoming_frame_queue_task_max) {
-            return false;
+        /* the task scheduled for the dropped frame takes the next one */
+        if (m_queued_frame_tasks >= m_queued_frames_count) {
+            return;
         }
+        ++m_queued_frame_tasks;
+        lock.unlock();
+        /* the frame stays in the ring, so the task is small enough to be stored in place whatever the sizes of its members */
+        auto task = [this]() { process_queued_frame(); };
+        static_assert(render_thread_executor::task_t::fits_inline<decltype(task)>(), "The frame task must not allocate on enqueue.");
+        m_scheduler.enqueue(lane::frame, task);
+    }
 
-        auto task = [this, image, callback = (callback ? std::move(callback) : [](image_processing_result_sptr) {}), input_rotation, require_mirroring, target_orientation]() {
-            if (m_current_frame->is_locked()) {
-                std::cout << "[Warning] The interface for processing the previous frame is lock" << std::endl;
-            } else if (m_incoming_frame_queue_task_count == 1 && !m_ep_stopped) {
-                m_current_frame->lock();
-                m_ort->activate_context();
-                m_ort->prepare_rendering();
-                m_ep->push_frame(image, input_rotation, require_mirroring);
-      
+    /* offscreen_effect_player::process_queued_frame */
+    void offscreen_effect_player::process_queued_frame()
+    {
+        queued_frame frame;
+        {
+            std::lock_guard<std::mutex> lock(m_queued_frames_mutex);
+            --m_queued_frame_tasks;
+            if (m_queued_frames_count == 0) {
+                /* the frame of the task was dropped and the newer frames were taken by the previous tasks */
+                return;
+            }
+            frame = take_queued_frame();
+        }
+        process_frame(frame);
+        release_frame_queue_slot();
+    }
+
+    /* offscreen_effect_player::take_queued_frame */
+    offscreen_effect_player::queued_frame offscreen_effect_player::take_queued_frame()
+    {
+        auto frame = std::move(m_queued_frames[m_queued_frames_head]);
+        m_queued_frames_head = (m_queued_frames_head + 1) % m_queued_frames.size();
+        --m_queued_frames_count;
+        return frame;
+    }
+
+    /* offscreen_effect_player::process_frame */
+    void offscreen_effect_player::process_frame(queued_frame& frame)
+    {
+        BNB_OEP_TRACE_SCOPE("oep", "frame");
+        using bnb::oep::interfaces::frame_drop_reason;
+        using bnb::oep::interfaces::frame_stage;
+        using bnb::oep::profiling::now_ns;
+
+        auto& callback = frame.callback;
+        auto target_orientation = frame.target_orientation;
+        auto prefetch_mask = frame.prefetch_mask;
+        int32_t buffer_index = -1;
+        if (is_frame_outdated(frame.frame_seq)) {
+            drop_frame(callback, frame_drop_reason::outdated);
+        } else if (m_ep_stopped) {
+            drop_frame(callback, frame_drop_reason::stopped);
+        } else if ((buffer_index = acquire_result()) < 0) {
+            std::cout << "[Warning] All the interfaces for processing the previous frames are lock" << std::endl;
+            drop_frame(callback, frame_drop_reason::result_locked);
+        } else {
+            interfaces::frame_timings timings;
+            timings.enqueue_time_ns = frame.enqueue_time;
+            auto stage_start = now_ns();
+            timings.set(frame_stage::queue_wait, stage_start - frame.enqueue_time);
+
+            m_ort->activate_context();
+            /* each frame of the pipeline is rendered into the buffer of its own result */
+            m_ort->set_current_buffer_index(buffer_index);
+            m_ort->prepare_rendering();
+            stage_start = now_ns();
+            {
+                BNB_OEP_TRACE_SCOPE("oep", "push_frame");
+                m_ep->push_frame(frame.image, frame.input_rotation, frame.require_mirroring);
+            }
+            auto stage_end = now_ns();
+            timings.set(frame_stage::push_frame, stage_end - stage_start);
+
+            if (m_js_calls_pending) {
+                flush_pending_js_calls();
+            }
+            stage_start = now_ns();
+            {
+                BNB_OEP_TRACE_SCOPE("oep", "draw");
                 m_ep->draw();
-      
-                if (!m_ep_stopped) {
-                    m_ort->orient_image(*target_orientation);
-                    callback(m_current_frame);
-                } else {
-                    callback(nullptr);
+            }
+            stage_end = now_ns();
+            timings.set(frame_stage::draw, stage_end - stage_start);
+
+            if (!m_ep_stopped) {
+                stage_start = stage_end;
+                m_ort->orient_image(target_orientation);
+                /* the conversions of all the outputs are submitted together after the single rendering */
+                if (!frame.outputs.empty()) {
+                    m_ort->prefetch(frame.outputs);
+                } else if (prefetch_mask != 0) {
+                    m_prefetch_outputs.clear();
+                    for (uint32_t format = 0; prefetch_mask >> format != 0; ++format) {
+                        if (prefetch_mask & (1u << format)) {
+                            m_prefetch_outputs.push_back({static_cast<bnb::oep::interfaces::image_format>(format), target_orientation});
+                        }
+                    }
+                    m_ort->prefetch(m_prefetch_outputs);
+                }
+                timings.set(frame_stage::orient_image, now_ns() - stage_start);
+                if (m_gpu_timers_enabled) {
+                    /* the results of the previous frames */
+                    m_ort->collect_gpu_timings(m_gpu_timing_recorder);
+                }
+                m_frames_in_flight.push_back({buffer_index, std::move(callback), timings});
+                /* the oldest frames are delivered while the GPU is busy with the newest one */
+                while (m_frames_in_flight.size() >= static_cast<size_t>(m_pipeline_depth)) {
+                    complete_frame_in_flight();
+                }
+                if (!m_frames_in_flight.empty()) {
+                    schedule_idle_completion();
                 }
-                m_current_frame->unlock();
             } else {
-                callback(nullptr);
+                m_results[buffer_index].in_flight = false;
+                drop_frame(callback, frame_drop_reason::stopped);
+                complete_frames_in_flight();
             }
-            --m_incoming_frame_queue_task_count;
-        };
-
-        ++m_incoming_frame_queue_task_count;
-        m_scheduler.enqueue(task);
-        return true;
+        }
     }
 
     /* offscreen_effect_player::surface_changed */
     void offscreen_effect_player::surface_changed(int32_t width, int32_t height)
     {
         auto task = [this, width, height]() {
+            BNB_OEP_TRACE_SCOPE("oep", "surface_changed");
             m_ort->activate_context();
+            complete_frames_in_flight();
             m_ep->surface_changed(width, height);
             m_ort->surface_changed(width, height);
             m_ort->deactivate_context();
         };
 
-        m_scheduler.enqueue(task);
+        m_scheduler.enqueue(lane::control, task);
+    }
+
+    /* offscreen_effect_player::set_pipeline_depth */
+    void offscreen_effect_player::set_pipeline_depth(int32_t depth)
+    {
+        if (depth < pipeline_depth_low_latency || depth > pipeline_depth_max) {
+            throw std::runtime_error("[ERROR] The pipeline depth must be in range [1..pipeline_depth_max].");
+        }
+
+        auto task = [this, depth]() {
+            BNB_OEP_TRACE_SCOPE("oep", "set_pipeline_depth");
+            m_ort->activate_context();
+            complete_frames_in_flight();
+            m_pipeline_depth = depth;
+            resize_result_pool();
+            m_ort->deactivate_context();
+        };
+        m_scheduler.enqueue(lane::control, task);
+    }
+
+    /* offscreen_effect_player::set_result_pool_size */
+    void offscreen_effect_player::set_result_pool_size(int32_t size)
+    {
+        if (size < 1 || size > result_pool_size_max) {
+            throw std::runtime_error("[ERROR] The result pool size must be in range [1..result_pool_size_max].");
+        }
+
+        auto task = [this, size]() {
+            BNB_OEP_TRACE_SCOPE("oep", "set_result_pool_size");
+            m_ort->activate_context();
+            complete_frames_in_flight();
+            m_result_pool_size = size;
+            resize_result_pool();
+            m_ort->deactivate_context();
+        };
+        m_scheduler.enqueue(lane::control, task);
+    }
+
+    /* offscreen_effect_player::set_backpressure_policy */
+    void offscreen_effect_player::set_backpressure_policy(interfaces::backpressure_policy policy, int32_t queue_depth)
+    {
+        if (queue_depth < 1 || queue_depth > frame_queue_depth_max) {
+            throw std::runtime_error("[ERROR] The frame queue depth must be in range [1..frame_queue_depth_max].");
+        }
+
+        m_frame_queue_depth = queue_depth;
+        m_backpressure_policy = policy;
+        /* the producers blocked with the previous policy or depth may proceed now */
+        wake_blocked_producers();
+    }
+
+    /* offscreen_effect_player::set_processing_mode */
+    void offscreen_effect_player::set_processing_mode(interfaces::processing_mode mode)
+    {
+        m_processing_mode = mode;
+        set_pipeline_depth(mode == interfaces::processing_mode::offline ? pipeline_depth_throughput : pipeline_depth_low_latency);
+        wake_blocked_producers();
+    }
+
+    /* offscreen_effect_player::flush */
+    void offscreen_effect_player::flush()
+    {
+        if (std::this_thread::get_id() == render_thread_id) {
+            throw std::runtime_error("[ERROR] flush() must not be called from the render thread.");
+        }
+
+        /* the tasks are executed in order, so all the frames accepted before are already rendered */
+        auto task = [this]() {
+            BNB_OEP_TRACE_SCOPE("oep", "flush");
+            m_ort->activate_context();
+            complete_frames_in_flight();
+            m_ort->deactivate_context();
+        };
+        m_scheduler.enqueue_and_wait(lane::frame, task);
     }
 
     /* offscreen_effect_player::load_effect */
     void offscreen_effect_player::load_effect(const std::string& effect_path)
     {
-        auto task = [this, effect = effect_path]() {
+        /* the loading is in the same lane as the JS calls, so they keep the order of the calls. The coalesced
+        JS calls made before are executed by the task right before the loading, the ones made after it wait
+        for the loading, see flush_pending_js_calls() */
+        std::vector<js_call> calls_before;
+        {
+            std::lock_guard<std::mutex> lock(m_js_calls_mutex);
+            ++m_pending_effect_loads;
+            calls_before.swap(m_pending_js_calls);
+        }
+        auto task = [this, effect = effect_path, calls = std::move(calls_before)]() mutable {
+            BNB_OEP_TRACE_SCOPE("oep", "load_effect");
             m_ort->activate_context();
+            execute_js_calls(calls);
             m_ep->load_effect(effect);
+            {
+                std::lock_guard<std::mutex> lock(m_js_calls_mutex);
+                --m_pending_effect_loads;
+            }
+            flush_pending_js_calls();
             m_ort->deactivate_context();
         };
-        m_scheduler.enqueue(task);
+        /* the render thread takes the mutex too, so it is not held while waiting for a free slot of the lane */
+        m_scheduler.enqueue(lane::control, std::move(task));
     }
 
     /* offscreen_effect_player::unload_effect */
@@ -158,23 +416,385 @@ namespace bnb::oep
     /* offscreen_effect_player::call_js_method */
     void offscreen_effect_player::call_js_method(const std::string& method, const std::string& param)
     {
+        if (m_js_calls_coalescing) {
+            add_pending_js_call({method, param, nullptr, false});
+            return;
+        }
+
         auto task = [this, method = method, param = param]() {
+            BNB_OEP_TRACE_SCOPE("oep", "call_js_method");
             m_ort->activate_context();
             m_ep->call_js_method(method, param);
             m_ort->deactivate_context();
         };
-        m_scheduler.enqueue(task);
+        m_scheduler.enqueue(lane::control, task);
     }
 
     /* offscreen_effect_player::eval_js */
     void offscreen_effect_player::eval_js(const std::string& script, oep_eval_js_result_cb result_callback)
     {
+        if (m_js_calls_coalescing) {
+            add_pending_js_call({script, std::string(), std::move(result_callback), true});
+            return;
+        }
+
         auto task = [this, script = script, callback = std::move(result_callback)]() {
+            BNB_OEP_TRACE_SCOPE("oep", "eval_js");
             m_ort->activate_context();
             m_ep->eval_js(script, std::move(callback));
             m_ort->deactivate_context();
         };
-        m_scheduler.enqueue(task);
+        m_scheduler.enqueue(lane::control, task);
+    }
+
+    /* offscreen_effect_player::set_js_calls_coalescing */
+    void offscreen_effect_player::set_js_calls_coalescing(bool enabled)
+    {
+        m_js_calls_coalescing = enabled;
+        if (!enabled) {
+            /* the calls collected before must not be delayed until the next frame */
+            auto task = [this]() {
+                BNB_OEP_TRACE_SCOPE("oep", "flush_js_calls");
+                m_ort->activate_context();
+                flush_pending_js_calls();
+                m_ort->deactivate_context();
+            };
+            m_scheduler.enqueue(lane::control, task);
+        }
+    }
+
+    /* offscreen_effect_player::get_stage_histogram */
+    interfaces::latency_histogram_snapshot offscreen_effect_player::get_stage_histogram(interfaces::frame_stage stage)
+    {
+        if (stage < interfaces::frame_stage::queue_wait || stage >= interfaces::frame_stage::count) {
+            throw std::runtime_error("[ERROR] Unknown frame stage.");
+        }
+        return m_stage_histograms[static_cast<size_t>(stage)].snapshot();
+    }
+
+    /* offscreen_effect_player::reset_stage_histograms */
+    void offscreen_effect_player::reset_stage_histograms()
+    {
+        for (auto& histogram : m_stage_histograms) {
+            histogram.reset();
+        }
+    }
+
+    /* offscreen_effect_player::set_gpu_timers_enabled */
+    void offscreen_effect_player::set_gpu_timers_enabled(bool enabled)
+    {
+        auto task = [this, enabled]() {
+            BNB_OEP_TRACE_SCOPE("oep", "set_gpu_timers_enabled");
+            m_ort->activate_context();
+            m_ort->set_gpu_timers_enabled(enabled);
+            m_gpu_timers_enabled = enabled;
+            m_ort->deactivate_context();
+        };
+        m_scheduler.enqueue(lane::control, task);
+    }
+
+    /* offscreen_effect_player::acquire_result */
+    int32_t offscreen_effect_player::acquire_result()
+    {
+        /* the results are taken in turn, so the buffer of the last delivered frame is overwritten as late as possible */
+        auto count = static_cast<int32_t>(m_results.size());
+        int32_t index = -1;
+        uint32_t locked = 0;
+        for (int32_t i = 0; i < count; ++i) {
+            auto candidate = (m_next_buffer_index + i) % count;
+            auto& slot = m_results[candidate];
+            if (slot.result->is_locked()) {
+                ++locked;
+            } else if (!slot.in_flight && index < 0) {
+                index = candidate;
+            }
+        }
+        m_results_locked = locked;
+
+        if (index >= 0) {
+            m_results[index].in_flight = true;
+            m_next_buffer_index = (index + 1) % count;
+        }
+        return index;
+    }
+
+    /* offscreen_effect_player::resize_result_pool */
+    void offscreen_effect_player::resize_result_pool()
+    {
+        auto count = static_cast<size_t>(m_pipeline_depth + m_result_pool_size - 1);
+        /* the buffers of the results still locked by the consumers are not removed */
+        for (size_t i = count; i < m_results.size(); ++i) {
+            if (m_results[i].result->is_locked()) {
+                count = i + 1;
+            }
+        }
+        /* the render target of the application may have fewer render buffers, then the pipeline is shortened */
+        auto buffer_count = m_ort->set_buffer_count(static_cast<int32_t>(count));
+        if (static_cast<size_t>(buffer_count) < count) {
+            std::cout << "[WARNING] The render target supports " << buffer_count << " render buffers, the pipeline depth and the result pool size are reduced." << std::endl;
+            count = static_cast<size_t>(buffer_count);
+            m_pipeline_depth = std::min(m_pipeline_depth, buffer_count);
+            m_result_pool_size = buffer_count - m_pipeline_depth + 1;
+        }
+        while (m_results.size() < count) {
+            m_results.push_back({bnb::oep::interfaces::image_processing_result::create(m_ort, static_cast<int32_t>(m_results.size()))});
+        }
+        m_results.resize(count);
+        m_next_buffer_index = 0;
+    }
+
+    /* offscreen_effect_player::complete_frame_in_flight */
+    void offscreen_effect_player::complete_frame_in_flight()
+    {
+        auto frame = std::move(m_frames_in_flight.front());
+        m_frames_in_flight.pop_front();
+        m_results[frame.buffer_index].in_flight = false;
+        auto result = m_results[frame.buffer_index].result;
+
+        if (result->is_locked()) {
+            std::cout << "[Warning] The interface for processing the previous frame is lock" << std::endl;
+            drop_frame(frame.callback, interfaces::frame_drop_reason::result_locked);
+            return;
+        }
+
+        /* the result reads the buffer the frame was rendered into */
+        m_ort->set_current_buffer_index(frame.buffer_index);
+        result->set_frame_timings(frame.timings);
+        result->lock();
+        auto callback_start = profiling::now_ns();
+        {
+            BNB_OEP_TRACE_SCOPE("oep", "callback");
+            frame.callback(result);
+        }
+        auto callback_end = profiling::now_ns();
+        result->unlock();
+
+        /* the readback and conversion stages are measured by the result while the callback is running */
+        auto timings = result->get_frame_timings();
+        timings.set(interfaces::frame_stage::callback, callback_end - callback_start);
+        timings.set(interfaces::frame_stage::total, callback_end - timings.enqueue_time_ns);
+        result->set_frame_timings(timings);
+        record_frame_timings(timings);
+        ++m_processed_frames;
+    }
+
+    /* offscreen_effect_player::drop_frame */
+    void offscreen_effect_player::drop_frame(const oep_image_process_cb& callback, interfaces::frame_drop_reason reason)
+    {
+        ++m_dropped_frames[static_cast<size_t>(reason)];
+        if (callback) {
+            callback(nullptr);
+        }
+    }
+
+    /* offscreen_effect_player::get_stats */
+    interfaces::offscreen_effect_player_stats offscreen_effect_player::get_stats()
+    {
+        interfaces::offscreen_effect_player_stats stats;
+        stats.submitted = m_submitted_frames;
+        stats.processed = m_processed_frames;
+        for (size_t i = 0; i < m_dropped_frames.size(); ++i) {
+            stats.dropped[i] = m_dropped_frames[i];
+        }
+        stats.queue_depth = m_incoming_frame_queue_task_count;
+        stats.results_locked = m_results_locked;
+        stats.latency = m_stage_histograms[static_cast<size_t>(interfaces::frame_stage::total)].snapshot();
+        return stats;
+    }
+
+    /* offscreen_effect_player::record_frame_timings */
+    void offscreen_effect_player::record_frame_timings(const interfaces::frame_timings& timings)
+    {
+        for (size_t i = 0; i < m_stage_histograms.size(); ++i) {
+            if (timings.durations_ns[i] != interfaces::frame_timings::not_measured) {
+                m_stage_histograms[i].record(timings.durations_ns[i]);
+            }
+        }
+    }
+
+    /* offscreen_effect_player::complete_frames_in_flight */
+    void offscreen_effect_player::complete_frames_in_flight()
+    {
+        while (!m_frames_in_flight.empty()) {
+            complete_frame_in_flight();
+        }
+    }
+
+    /* offscreen_effect_player::schedule_idle_completion */
+    void offscreen_effect_player::schedule_idle_completion()
+    {
+        /* the executor is stopping on the destruction, and its final task delivers the frames in flight */
+        if (m_idle_completion_scheduled || m_destroy) {
+            return;
+        }
+        m_idle_completion_scheduled = true;
+
+        /* the background lane runs when no frame is pending, so the frames kept in the pipeline are
+        delivered when the stream pauses instead of waiting for the next frame forever */
+        auto task = [this]() {
+            BNB_OEP_TRACE_SCOPE("oep", "complete_idle_frames");
+            m_idle_completion_scheduled = false;
+            /* the next frame pushes them out of the pipeline itself, and schedules the task again */
+            if (m_frames_in_flight.empty() || m_scheduler.has_pending(lane::frame)) {
+                return;
+            }
+            m_ort->activate_context();
+            complete_frames_in_flight();
+            m_ort->deactivate_context();
+        };
+        m_scheduler.enqueue(lane::background, task);
+    }
+
+    /* offscreen_effect_player::acquire_frame_queue_slot */
+    bool offscreen_effect_player::acquire_frame_queue_slot()
+    {
+        using bnb::oep::interfaces::backpressure_policy;
+
+        switch (get_effective_backpressure_policy()) {
+            case backpressure_policy::latest_wins:
+                if (m_incoming_frame_queue_task_count >= static_cast<uint32_t>(m_frame_queue_depth.load())) {
+                    return false;
+                }
+                break;
+            case backpressure_policy::block_producer: {
+                std::unique_lock<std::mutex> lock(m_frame_queue_mutex);
+                ++m_blocked_producers;
+                m_frame_queue_cv.wait(lock, [this]() {
+                    return m_destroy
+                        || get_effective_backpressure_policy() != backpressure_policy::block_producer
+                        || m_incoming_frame_queue_task_count < static_cast<uint32_t>(m_frame_queue_depth.load());
+                });
+                --m_blocked_producers;
+                if (m_destroy) {
+                    return false;
+                }
+                /* incremented under the lock, so the other waiting producers see the slot as taken */
+                ++m_incoming_frame_queue_task_count;
+                return true;
+            }
+            case backpressure_policy::drop_oldest:
+                /* never rejected, the queue is bounded by dropping the oldest frames, see push_queued_frame() */
+                break;
+            case backpressure_policy::lossless_fifo:
+                /* the lane of the render thread is bounded, so the frames beyond it are rejected instead of blocking */
+                if (m_incoming_frame_queue_task_count >= static_cast<uint32_t>(frame_queue_depth_max)) {
+                    return false;
+                }
+                break;
+        }
+
+        ++m_incoming_frame_queue_task_count;
+        return true;
+    }
+
+    /* offscreen_effect_player::release_frame_queue_slot */
+    void offscreen_effect_player::release_frame_queue_slot()
+    {
+        --m_incoming_frame_queue_task_count;
+        /* the mutex is only touched when somebody is actually waiting */
+        if (m_blocked_producers > 0) {
+            wake_blocked_producers();
+        }
+    }
+
+    /* offscreen_effect_player::is_frame_outdated */
+    bool offscreen_effect_player::is_frame_outdated(uint64_t frame_seq) const
+    {
+        using bnb::oep::interfaces::backpressure_policy;
+
+        switch (get_effective_backpressure_policy()) {
+            case backpressure_policy::latest_wins:
+                /* only the newest accepted frame is rendered */
+                return frame_seq != m_last_frame_seq;
+            case backpressure_policy::drop_oldest:
+                /* the older frames are dropped on submission, see push_queued_frame() */
+            case backpressure_policy::block_producer:
+            case backpressure_policy::lossless_fifo:
+                break;
+        }
+        return false;
+    }
+
+    /* offscreen_effect_player::add_pending_js_call */
+    void offscreen_effect_player::add_pending_js_call(js_call&& call)
+    {
+        bool schedule_flush = false;
+        {
+            std::lock_guard<std::mutex> lock(m_js_calls_mutex);
+            auto it = m_pending_js_calls.end();
+            if (!call.is_eval) {
+                it = std::find_if(m_pending_js_calls.begin(), m_pending_js_calls.end(), [&call](const js_call& pending) {
+                    return !pending.is_eval && pending.method == call.method;
+                });
+            }
+            if (it != m_pending_js_calls.end()) {
+                it->param = std::move(call.param);
+            } else {
+                m_pending_js_calls.push_back(std::move(call));
+            }
+            schedule_flush = !m_js_calls_pending.exchange(true);
+        }
+
+        if (schedule_flush) {
+            /* the frames flush the calls before drawing, this task only handles the case when there are no frames */
+            auto task = [this]() {
+                BNB_OEP_TRACE_SCOPE("oep", "flush_js_calls");
+                if (m_js_calls_pending) {
+                    m_ort->activate_context();
+                    flush_pending_js_calls();
+                    m_ort->deactivate_context();
+                }
+            };
+            m_scheduler.enqueue(lane::background, task);
+        }
+    }
+
+    /* offscreen_effect_player::flush_pending_js_calls */
+    void offscreen_effect_player::flush_pending_js_calls()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_js_calls_mutex);
+            if (m_pending_effect_loads > 0) {
+                /* the calls are made after load_effect() and are flushed by its task after the loading */
+                return;
+            }
+            m_js_calls_batch.swap(m_pending_js_calls);
+            m_js_calls_pending = false;
+        }
+        execute_js_calls(m_js_calls_batch);
+    }
+
+    /* offscreen_effect_player::execute_js_calls */
+    void offscreen_effect_player::execute_js_calls(std::vector<js_call>& calls)
+    {
+        for (auto& call : calls) {
+            if (call.is_eval) {
+                m_ep->eval_js(call.method, std::move(call.result_callback));
+            } else {
+                m_ep->call_js_method(call.method, call.param);
+            }
+        }
+        calls.clear();
+    }
+
+    /* offscreen_effect_player::get_effective_backpressure_policy */
+    interfaces::backpressure_policy offscreen_effect_player::get_effective_backpressure_policy() const
+    {
+        /* offline processing never drops frames and never rejects them */
+        if (m_processing_mode == interfaces::processing_mode::offline) {
+            return interfaces::backpressure_policy::block_producer;
+        }
+        return m_backpressure_policy;
+    }
+
+    /* offscreen_effect_player::wake_blocked_producers */
+    void offscreen_effect_player::wake_blocked_producers()
+    {
+        {
+            /* prevents the notification from being lost between the check of the predicate and the wait */
+            std::lock_guard<std::mutex> lock(m_frame_queue_mutex);
+        }
+        m_frame_queue_cv.notify_all();
     }
 
 } /* namespace bnb::oep */
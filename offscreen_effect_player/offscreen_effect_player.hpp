@@ -3,7 +3,13 @@
 #include <interfaces/offscreen_effect_player.hpp>
 #include <interfaces/offscreen_render_target.hpp>
 #include <interfaces/pixel_buffer.hpp>
-#include "thread_pool.h"
+#include <profiling/latency_histogram.hpp>
+#include <array>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "render_thread_executor.hpp"
 
 namespace bnb::oep
 {
@@ -15,10 +21,22 @@ namespace bnb::oep
 
         ~offscreen_effect_player();
 
-        bool process_image_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::optional<bnb::oep::interfaces::rotation> target_orientation) override;
+        bool process_image_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::optional<bnb::oep::interfaces::rotation> target_orientation, const std::vector<bnb::oep::interfaces::image_format>& prefetch_formats = {}) override;
+
+        bool process_image_outputs_async(pixel_buffer_sptr image, bnb::oep::interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, std::vector<bnb::oep::interfaces::output_spec> outputs) override;
 
         void surface_changed(int32_t width, int32_t height) override;
 
+        void set_pipeline_depth(int32_t depth) override;
+
+        void set_result_pool_size(int32_t size) override;
+
+        void set_backpressure_policy(interfaces::backpressure_policy policy, int32_t queue_depth) override;
+
+        void set_processing_mode(interfaces::processing_mode mode) override;
+
+        void flush() override;
+
         void load_effect(const std::string& effect_path) override;
 
         void unload_effect() override;
@@ -33,13 +51,134 @@ namespace bnb::oep
 
         void eval_js(const std::string& script, oep_eval_js_result_cb result_callback) override;
 
+        void set_js_calls_coalescing(bool enabled) override;
+
+        interfaces::latency_histogram_snapshot get_stage_histogram(interfaces::frame_stage stage) override;
+
+        void reset_stage_histograms() override;
+
+        void set_gpu_timers_enabled(bool enabled) override;
+
+        interfaces::offscreen_effect_player_stats get_stats() override;
+
+    private:
+        using lane = render_thread_executor::lane;
+
+        /* the frame lane keeps the room for flush() and the other tasks of the frame lane */
+        static_assert(frame_queue_depth_max < render_thread_executor::queue_size_default, "The frame queue must fit into the frame lane.");
+
+        struct frame_in_flight
+        {
+            int32_t buffer_index{0};
+            oep_image_process_cb callback;
+            interfaces::frame_timings timings;
+        }; /* struct frame_in_flight */
+
+        /* frame accepted by process_image_async() and waiting for processing */
+        struct queued_frame
+        {
+            pixel_buffer_sptr image;
+            oep_image_process_cb callback;
+            std::vector<interfaces::output_spec> outputs;
+            interfaces::rotation input_rotation{interfaces::rotation::deg0};
+            interfaces::rotation target_orientation{interfaces::rotation::deg0};
+            bool require_mirroring{false};
+            uint32_t prefetch_mask{0};
+            uint64_t frame_seq{0};
+            int64_t enqueue_time{0};
+        }; /* struct queued_frame */
+
+        struct result_slot
+        {
+            image_processing_result_sptr result;
+            bool in_flight{false}; /* the frame rendered into the buffer of the result is not delivered yet */
+        }; /* struct result_slot */
+
+        struct js_call
+        {
+            std::string method; /* method name, or the script for eval_js */
+            std::string param;
+            oep_eval_js_result_cb result_callback;
+            bool is_eval{false};
+        }; /* struct js_call */
+
+        bool enqueue_frame(pixel_buffer_sptr image, interfaces::rotation input_rotation, bool require_mirroring, oep_image_process_cb callback, interfaces::rotation target_orientation, uint32_t prefetch_mask, std::vector<interfaces::output_spec> outputs);
+        void push_queued_frame(queued_frame&& frame, bool drop_oldest);
+        void process_queued_frame();
+        queued_frame take_queued_frame();
+        void process_frame(queued_frame& frame);
+
+        int32_t acquire_result();
+        void resize_result_pool();
+        void complete_frame_in_flight();
+        void complete_frames_in_flight();
+        void schedule_idle_completion();
+        void record_frame_timings(const interfaces::frame_timings& timings);
+        void drop_frame(const oep_image_process_cb& callback, interfaces::frame_drop_reason reason);
+
+        bool acquire_frame_queue_slot();
+        void release_frame_queue_slot();
+        bool is_frame_outdated(uint64_t frame_seq) const;
+        interfaces::backpressure_policy get_effective_backpressure_policy() const;
+        void wake_blocked_producers();
+
+        void add_pending_js_call(js_call&& call);
+        void flush_pending_js_calls();
+        void execute_js_calls(std::vector<js_call>& calls);
+
     private:
         effect_player_sptr m_ep;
         offscreen_render_target_sptr m_ort;
-        thread_pool m_scheduler;
+        render_thread_executor m_scheduler;
         std::thread::id render_thread_id;
-        image_processing_result_sptr m_current_frame;
-        std::atomic<uint16_t> m_incoming_frame_queue_task_count = 0;
+        /* the members below are accessed from the render thread only */
+        /* the result with the index N reads the render buffer N */
+        std::vector<result_slot> m_results;
+        std::deque<frame_in_flight> m_frames_in_flight;
+        int32_t m_pipeline_depth{pipeline_depth_low_latency};
+        int32_t m_result_pool_size{result_pool_size_default};
+        int32_t m_next_buffer_index{0};
+        /* the task delivering the frames in flight when no frame is pending is in the background lane */
+        bool m_idle_completion_scheduled{false};
+        /* the outputs of the prefetched formats, reused for each frame */
+        std::vector<interfaces::output_spec> m_prefetch_outputs;
+        std::atomic<uint32_t> m_incoming_frame_queue_task_count = 0;
+        /* sequence number of the last accepted frame, frames are numbered from 1 */
+        std::atomic<uint64_t> m_last_frame_seq{0};
+        std::atomic<interfaces::backpressure_policy> m_backpressure_policy{interfaces::backpressure_policy::latest_wins};
+        std::atomic<int32_t> m_frame_queue_depth{frame_queue_depth_default};
+        std::atomic<interfaces::processing_mode> m_processing_mode{interfaces::processing_mode::realtime};
+        /* producers waiting for a free slot with backpressure_policy::block_producer */
+        std::atomic<int32_t> m_blocked_producers{0};
+        std::mutex m_frame_queue_mutex;
+        std::condition_variable m_frame_queue_cv;
+        /* ring of the frames waiting for processing, preallocated for frame_queue_depth_max frames. With
+        backpressure_policy::drop_oldest at most 'queue depth' of them, the older frames are dropped on submission,
+        so they do not keep their images in the queue */
+        std::vector<queued_frame> m_queued_frames;
+        size_t m_queued_frames_head{0};
+        size_t m_queued_frames_count{0};
+        /* tasks of the frame lane not started yet, each takes the oldest frame of the ring if there is one.
+        Never less than the number of the frames in the ring */
+        size_t m_queued_frame_tasks{0};
+        std::mutex m_queued_frames_mutex;
+        std::atomic_bool m_js_calls_coalescing{false};
+        /* set while the pending JS calls are waiting for the flush */
+        std::atomic_bool m_js_calls_pending{false};
+        std::mutex m_js_calls_mutex;
+        std::vector<js_call> m_pending_js_calls;
+        /* load_effect() calls not executed yet, the pending JS calls are not flushed before them. Guarded by m_js_calls_mutex */
+        int32_t m_pending_effect_loads{0};
+        /* swapped with the pending calls on the flush, so their memory is reused, render thread only */
+        std::vector<js_call> m_js_calls_batch;
+        std::array<profiling::latency_histogram, static_cast<size_t>(interfaces::frame_stage::count)> m_stage_histograms;
+        /* records the GPU timings to the histograms, created once to avoid allocations per frame */
+        oep_gpu_timing_cb m_gpu_timing_recorder;
+        bool m_gpu_timers_enabled{false}; /* render thread only */
+        std::atomic<uint64_t> m_submitted_frames{0};
+        std::atomic<uint64_t> m_processed_frames{0};
+        std::atomic<uint32_t> m_results_locked{0};
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(interfaces::frame_drop_reason::count)> m_dropped_frames{};
         std::atomic_bool m_destroy {false};
         std::atomic_bool m_ep_stopped {false};
     }; /* class offscreen_effect_player */
@@ -0,0 +1,497 @@
+#pragma once
+
+#include <profiling/trace.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace bnb::oep
+{
+
+    /* Move only type erased callable 'void()'. The callables up to InlineSize bytes are stored in place,
+     * so creating and moving such a task never allocates. Bigger callables are allocated on the heap */
+    template<size_t InlineSize>
+    class inplace_task
+    {
+    public:
+        template<class T>
+        static constexpr bool fits_inline()
+        {
+            return sizeof(T) <= InlineSize && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>;
+        }
+
+    public:
+        inplace_task() = default;
+
+        template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, inplace_task>>>
+        inplace_task(F&& f)
+        {
+            using callable_t = std::decay_t<F>;
+            if constexpr (fits_inline<callable_t>()) {
+                new (m_storage) callable_t(std::forward<F>(f));
+                m_ops = &inline_ops<callable_t>;
+            } else {
+                new (m_storage) callable_t*(new callable_t(std::forward<F>(f)));
+                m_ops = &heap_ops<callable_t>;
+            }
+        }
+
+        inplace_task(inplace_task&& other) noexcept
+        {
+            move_from(other);
+        }
+
+        inplace_task& operator=(inplace_task&& other) noexcept
+        {
+            if (this != &other) {
+                reset();
+                move_from(other);
+            }
+            return *this;
+        }
+
+        inplace_task(const inplace_task&) = delete;
+        inplace_task& operator=(const inplace_task&) = delete;
+
+        ~inplace_task()
+        {
+            reset();
+        }
+
+        void operator()()
+        {
+            m_ops->invoke(m_storage);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_ops != nullptr;
+        }
+
+        void reset() noexcept
+        {
+            if (m_ops != nullptr) {
+                m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+    private:
+        struct operations
+        {
+            void (*invoke)(void* storage);
+            void (*move)(void* from, void* to);
+            void (*destroy)(void* storage);
+        }; /* struct operations */
+
+        template<class T>
+        static void invoke_inline(void* storage)
+        {
+            (*static_cast<T*>(storage))();
+        }
+
+        template<class T>
+        static void move_inline(void* from, void* to)
+        {
+            new (to) T(std::move(*static_cast<T*>(from)));
+            static_cast<T*>(from)->~T();
+        }
+
+        template<class T>
+        static void destroy_inline(void* storage)
+        {
+            static_cast<T*>(storage)->~T();
+        }
+
+        template<class T>
+        static void invoke_heap(void* storage)
+        {
+            (**static_cast<T**>(storage))();
+        }
+
+        template<class T>
+        static void move_heap(void* from, void* to)
+        {
+            new (to) T*(*static_cast<T**>(from));
+        }
+
+        template<class T>
+        static void destroy_heap(void* storage)
+        {
+            delete *static_cast<T**>(storage);
+        }
+
+        template<class T>
+        static inline const operations inline_ops{&invoke_inline<T>, &move_inline<T>, &destroy_inline<T>};
+
+        template<class T>
+        static inline const operations heap_ops{&invoke_heap<T>, &move_heap<T>, &destroy_heap<T>};
+
+        void move_from(inplace_task& other) noexcept
+        {
+            if (other.m_ops != nullptr) {
+                other.m_ops->move(other.m_storage, m_storage);
+                m_ops = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+        const operations* m_ops{nullptr};
+    }; /* class inplace_task */
+
+
+    /* Bounded lock free multiple producers single consumer ring of preallocated task slots */
+    template<class Task>
+    class task_ring
+    {
+    public:
+        /* size is rounded up to the power of two */
+        explicit task_ring(size_t size)
+        {
+            size_t capacity = 2;
+            while (capacity < size) {
+                capacity <<= 1;
+            }
+            m_cells = std::make_unique<cell[]>(capacity);
+            m_mask = capacity - 1;
+            for (size_t i = 0; i < capacity; ++i) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /* moves the task into the ring only on success, returns false if the ring is full */
+        bool try_push(Task& task)
+        {
+            auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& c = m_cells[pos & m_mask];
+                auto seq = c.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        c.task = std::move(task);
+                        c.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /* called from the consumer thread only */
+        bool try_pop(Task& task)
+        {
+            auto& c = m_cells[m_dequeue_pos & m_mask];
+            if (c.sequence.load(std::memory_order_acquire) != m_dequeue_pos + 1) {
+                return false;
+            }
+            task = std::move(c.task);
+            c.sequence.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+            ++m_dequeue_pos;
+            return true;
+        }
+
+        /* called from the consumer thread only */
+        bool has_pending() const
+        {
+            return m_cells[m_dequeue_pos & m_mask].sequence.load(std::memory_order_acquire) == m_dequeue_pos + 1;
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<size_t> sequence{0};
+            Task task;
+        }; /* struct cell */
+
+    private:
+        std::unique_ptr<cell[]> m_cells;
+        size_t m_mask{0};
+        alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+        alignas(64) size_t m_dequeue_pos{0};
+    }; /* class task_ring */
+
+
+    /* Executes the tasks one by one on its own thread, the render thread of the offscreen effect player.
+     * The tasks are passed through the lanes, bounded lock free rings of preallocated slots, so enqueueing
+     * a task fitting into a slot never allocates and never locks a mutex. The mutex is only used to put
+     * the idle render thread or the producers of a full lane to sleep and to wake them up.
+     * Scheduling order: all the pending control tasks run first, then the frame tasks, the background tasks
+     * run when nothing else is pending, or after background_starvation_limit other tasks while waiting.
+     * The tasks of the same lane run in the order of enqueueing */
+    class render_thread_executor
+    {
+    public:
+        enum class lane : int32_t
+        {
+            control,    /* short latency sensitive commands applied before the next frame */
+            frame,      /* frame processing */
+            background, /* deferred work done when the render thread is idle, it must not delay frames */
+            count
+        }; /* enum class lane */
+
+        /* size in bytes of the callable stored in place in the slot of the ring */
+        static constexpr size_t task_inline_size = 128;
+        /* default number of the slots in the ring of each lane */
+        static constexpr size_t queue_size_default = 256;
+        /* maximum number of the tasks executed while a background task is waiting */
+        static constexpr int32_t background_starvation_limit = 8;
+
+        using task_t = inplace_task<task_inline_size>;
+
+    public:
+        explicit render_thread_executor(size_t queue_size = queue_size_default)
+            : m_lanes{task_ring<task_t>(queue_size), task_ring<task_t>(queue_size), task_ring<task_t>(queue_size)}
+        {
+            m_worker = std::thread([this]() { run(); });
+        }
+
+        ~render_thread_executor()
+        {
+            stop({});
+        }
+
+        render_thread_executor(const render_thread_executor&) = delete;
+        render_thread_executor& operator=(const render_thread_executor&) = delete;
+
+        /* Add the task to the lane without waiting for its execution. If the lane is full the calling
+         * thread sleeps until the render thread takes a task from it, so the lane holds at most
+         * queue_size tasks and the producers do not spin */
+        template<class F>
+        void enqueue(lane l, F&& f)
+        {
+            producer_scope producer(*this);
+            if (m_stop) {
+                throw std::runtime_error("[ERROR] Enqueue on stopped render thread executor.");
+            }
+
+            task_t task(std::forward<F>(f));
+            auto& ring = m_lanes[static_cast<size_t>(l)];
+            if (!ring.try_push(task)) {
+                if (is_executor_thread()) {
+                    /* the render thread would wait for itself */
+                    throw std::runtime_error("[ERROR] The render thread task queue is overflowed.");
+                }
+                wait_for_free_slot(ring, task);
+            }
+            wake_consumer();
+        }
+
+        /* Add the task to the lane and wait for its result. The exception thrown by the task is rethrown.
+         * Called from the render thread the task is executed immediately */
+        template<class F>
+        auto enqueue_and_wait(lane l, F&& f) -> std::invoke_result_t<F>
+        {
+            using return_type = std::invoke_result_t<F>;
+
+            if (is_executor_thread()) {
+                return f();
+            }
+
+            std::packaged_task<return_type()> task(std::forward<F>(f));
+            auto future = task.get_future();
+            enqueue(l, [&task]() { task(); });
+            return future.get();
+        }
+
+        /* Stop accepting tasks, execute all the pending tasks of all the lanes, including the ones of the enqueue()
+         * calls racing with stop(), then the final task, and join the render thread. Must not be called from the render thread */
+        void stop(task_t final_task)
+        {
+            if (!m_worker.joinable()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_final_task = std::move(final_task);
+                m_stop = true;
+            }
+            m_condition.notify_one();
+            m_worker.join();
+        }
+
+        bool is_executor_thread() const
+        {
+            return std::this_thread::get_id() == m_worker.get_id();
+        }
+
+        /* called from the render thread only, e.g. by a task deciding whether the next frames are coming */
+        bool has_pending(lane l) const
+        {
+            return m_lanes[static_cast<size_t>(l)].has_pending();
+        }
+
+    private:
+        /* counts the enqueue() calls in progress, so the render thread does not finish before their tasks are pushed */
+        class producer_scope
+        {
+        public:
+            explicit producer_scope(render_thread_executor& executor)
+                : m_executor(executor)
+            {
+                /* seq_cst pairs with the stop flag: either enqueue() sees the flag or run() sees the producer */
+                m_executor.m_active_producers.fetch_add(1);
+            }
+
+            ~producer_scope()
+            {
+                if (m_executor.m_active_producers.fetch_sub(1) == 1 && m_executor.m_stop) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_executor.m_mutex);
+                    }
+                    m_executor.m_condition.notify_one();
+                }
+            }
+
+            producer_scope(const producer_scope&) = delete;
+            producer_scope& operator=(const producer_scope&) = delete;
+
+        private:
+            render_thread_executor& m_executor;
+        }; /* class producer_scope */
+
+        void wake_consumer()
+        {
+            /* pairs with the fence in run(): either the producer sees the sleeping flag or the render thread sees the task */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_consumer_sleeping.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                }
+                m_condition.notify_one();
+            }
+        }
+
+        void wait_for_free_slot(task_ring<task_t>& ring, task_t& task)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiting_producers.fetch_add(1);
+            /* pairs with the fence in wake_producers(): either the render thread sees the waiting producer
+            or the producer sees the slot released by it */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_slot_released.wait(lock, [&ring, &task]() { return ring.try_push(task); });
+            m_waiting_producers.fetch_sub(1);
+        }
+
+        /* called from the render thread only, after a task is taken from a lane */
+        void wake_producers()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waiting_producers.load(std::memory_order_relaxed) > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                }
+                m_slot_released.notify_all();
+            }
+        }
+
+        /* called from the render thread only */
+        bool has_pending_task() const
+        {
+            for (auto& ring : m_lanes) {
+                if (ring.has_pending()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /* called from the render thread only. No task is pending or may be pushed anymore */
+        bool is_drained() const
+        {
+            return m_stop && m_active_producers.load() == 0 && !has_pending_task();
+        }
+
+        /* called from the render thread only */
+        bool try_pop(task_t& task)
+        {
+            auto& control = m_lanes[static_cast<size_t>(lane::control)];
+            auto& frame = m_lanes[static_cast<size_t>(lane::frame)];
+            auto& background = m_lanes[static_cast<size_t>(lane::background)];
+
+            if (!background.has_pending()) {
+                m_background_wait = 0;
+            } else if (m_background_wait >= background_starvation_limit) {
+                m_background_wait = 0;
+                return background.try_pop(task);
+            }
+
+            if (control.try_pop(task) || frame.try_pop(task)) {
+                ++m_background_wait;
+                return true;
+            }
+            m_background_wait = 0;
+            return background.try_pop(task);
+        }
+
+        void run()
+        {
+            BNB_OEP_TRACE_THREAD_NAME("oep render thread");
+            task_t task;
+            for (;;) {
+                if (try_pop(task)) {
+                    wake_producers();
+                    execute(task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_consumer_sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                m_condition.wait(lock, [this]() { return has_pending_task() || is_drained(); });
+                m_consumer_sleeping.store(false, std::memory_order_relaxed);
+                if (!has_pending_task()) {
+                    task = std::move(m_final_task);
+                    lock.unlock();
+                    if (task) {
+                        execute(task);
+                    }
+                    return;
+                }
+            }
+        }
+
+        static void execute(task_t& task)
+        {
+            try {
+                task();
+            } catch (std::exception& e) {
+                std::cout << "[ERROR] Render thread task failed: " << e.what() << std::endl;
+            }
+            /* the captured resources are released right after the execution */
+            task.reset();
+        }
+
+    private:
+        task_ring<task_t> m_lanes[static_cast<size_t>(lane::count)];
+        /* number of the tasks executed while a background task is waiting, render thread only */
+        int32_t m_background_wait{0};
+        std::atomic_bool m_consumer_sleeping{false};
+        /* producers sleeping in enqueue() until a slot of the full lane is released */
+        std::atomic<int32_t> m_waiting_producers{0};
+        /* enqueue() calls in progress, see producer_scope */
+        std::atomic<int32_t> m_active_producers{0};
+        std::atomic_bool m_stop{false};
+        task_t m_final_task;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::condition_variable m_slot_released;
+        std::thread m_worker;
+    }; /* class render_thread_executor */
+
+} /* namespace bnb::oep */
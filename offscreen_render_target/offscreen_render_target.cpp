@@ -1,5 +1,10 @@
 #include "offscreen_render_target.hpp"
 
+#include <profiling/trace.hpp>
+#include <memory/copy_planes.hpp>
+#include <algorithm>
+#include <cstring>
+
 namespace bnb::oep
 {
     const int drawing_plane_vert_count = 4;
@@ -30,6 +35,38 @@ namespace bnb::oep
     };
     // clang-format on
 
+    /* maximum number of the persistently mapped readback buffers which may be pending or held by the pixel buffers
+    at the same time. The readbacks above it go to the buffers which are copied into the pool on mapping */
+    constexpr size_t readback_ring_max_size = 8;
+
+    /* keeps the readback buffers mapped and the context alive after deinit() until the last pixel data pointing
+    into them is released. Destroyed by the deleter of the pixel data, so on the thread releasing it */
+    class retained_readbacks
+    {
+    public:
+        retained_readbacks(render_context_sptr rc, std::vector<std::unique_ptr<pixel_pack_buffer>> buffers)
+            : m_rc(std::move(rc))
+            , m_buffers(std::move(buffers))
+        {
+        }
+
+        ~retained_readbacks()
+        {
+            m_rc->activate();
+            m_buffers.clear();
+            m_rc->delete_context();
+        }
+
+    private:
+        render_context_sptr m_rc;
+        std::vector<std::unique_ptr<pixel_pack_buffer>> m_buffers;
+    }; /* class retained_readbacks */
+
+    bool is_rotated_by_90(bnb::oep::interfaces::rotation orient)
+    {
+        return orient == bnb::oep::interfaces::rotation::deg90 || orient == bnb::oep::interfaces::rotation::deg270;
+    }
+
     const char* shader_vec_prog =
         "precision highp float;\n "
         "layout (location = 0) in vec3 aPos;\n"
@@ -93,6 +130,7 @@ namespace bnb::oep
 
             GL_CALL(glGenFramebuffers(1, &m_framebuffer));
             GL_CALL(glGenFramebuffers(1, &m_post_processing_framebuffer));
+            GL_CALL(glGenFramebuffers(1, &m_readback_framebuffer));
             deactivate_context();
         });
     }
@@ -118,8 +156,32 @@ namespace bnb::oep
                 GL_CALL(glDeleteFramebuffers(1, &m_post_processing_framebuffer));
                 m_post_processing_framebuffer = 0;
             }
+            if (glIsFramebuffer(m_readback_framebuffer)) {
+                GL_CALL(glDeleteFramebuffers(1, &m_readback_framebuffer));
+                m_readback_framebuffer = 0;
+            }
             delete_textures();
-            m_rc->delete_context();
+            /* release GL objects while the context is still alive */
+            for (auto& buffer : m_buffers) {
+                release_readbacks(buffer);
+            }
+            m_buffers.clear();
+            m_buffers.resize(1);
+            m_current_buffer = 0;
+            auto retained = retain_held_readbacks();
+            m_readback_ring.clear();
+            m_buffer_pool->trim();
+            m_yuv_i420_converter.reset();
+            m_yuv_nv12_converter.reset();
+            m_bpc8_converter.reset();
+            m_resampler.reset();
+            m_gpu_timer.reset();
+            if (retained != nullptr) {
+                /* the context is deleted by the last owner of the retained readbacks, it may be this one */
+                deactivate_context();
+            } else {
+                m_rc->delete_context();
+            }
         });
     }
 
@@ -128,10 +190,11 @@ namespace bnb::oep
     {
         m_width = width;
         m_height = height;
-        m_swap_sizes = false;
         activate_context();
         delete_textures();
         deactivate_context();
+        /* the buffers of the previous size are freed when released */
+        m_buffer_pool->trim();
     }
 
     /* offscreen_render_target::activate_context */
@@ -146,89 +209,210 @@ namespace bnb::oep
         m_rc->deactivate();
     }
 
+    /* offscreen_render_target::set_buffer_count */
+    int32_t offscreen_render_target::set_buffer_count(int32_t count)
+    {
+        if (count <= 0) {
+            throw std::runtime_error("[ERROR] The number of render buffers must be greater than zero.");
+        }
+
+        /* textures of the removed buffers are deleted, the remaining buffers keep their content */
+        for (size_t i = static_cast<size_t>(count); i < m_buffers.size(); ++i) {
+            delete_textures(m_buffers[i]);
+        }
+        m_buffers.resize(static_cast<size_t>(count));
+        if (m_current_buffer >= m_buffers.size()) {
+            m_current_buffer = 0;
+        }
+        return count;
+    }
+
+    /* offscreen_render_target::set_current_buffer_index */
+    void offscreen_render_target::set_current_buffer_index(int32_t index)
+    {
+        if (index < 0 || static_cast<size_t>(index) >= m_buffers.size()) {
+            throw std::runtime_error("[ERROR] Invalid render buffer index.");
+        }
+        m_current_buffer = static_cast<size_t>(index);
+    }
+
     /* offscreen_render_target::prepare_rendering */
     void offscreen_render_target::prepare_rendering()
     {
-        if (m_offscreen_render_texture == 0) {
-            generate_texture(m_offscreen_render_texture, m_width, m_height);
+        BNB_OEP_TRACE_SCOPE("ort", "prepare_rendering");
+        auto& buffer = m_buffers[m_current_buffer];
+        if (buffer.render_texture == 0) {
+            generate_texture(buffer.render_texture, m_width, m_height);
         }
 
         GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer));
-        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_offscreen_render_texture, 0));
+        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer.render_texture, 0));
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
             GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
             std::cout << "[ERROR] Failed to make complete framebuffer object " << status << std::endl;
             return;
         }
-        m_active_texture = m_offscreen_render_texture;
-        m_last_framebuffer = m_offscreen_render_texture;
+        buffer.active_texture = buffer.render_texture;
+        buffer.deferred_orientation.reset();
+
+        if (m_readback_format_hint.has_value() && has_readback(buffer, {*m_readback_format_hint, buffer.orientation})) {
+            /* the readback issued in advance for the previous frame of this buffer was not used,
+            so do not issue it for the next frames until a format is requested again */
+            m_readback_format_hint.reset();
+        }
+        release_readbacks(buffer);
+        /* the capacity is kept, so caching the images of the next frames does not allocate */
+        buffer.images.clear();
+        buffer.orientation = bnb::oep::interfaces::rotation::deg0;
+
+        if (m_gpu_timer != nullptr) {
+            /* the pass lasts until orient_image() */
+            m_gpu_timer->begin(static_cast<int32_t>(bnb::oep::interfaces::frame_stage::gpu_draw));
+        }
     }
 
     /* offscreen_render_target::orient_image */
     void offscreen_render_target::orient_image(bnb::oep::interfaces::rotation orient)
     {
-        GL_CALL(glFlush());
-
-        using ns = bnb::oep::interfaces::rotation;
-        int32_t draw_indent{0};
-        bool swap_sizes = m_swap_sizes;
-        switch (orient) {
-            case ns::deg0:
-                draw_indent = 0 * drawing_plane_vert_count;
-                swap_sizes = false;
-                break;
-            case ns::deg90:
-                draw_indent = 1 * drawing_plane_vert_count;
-                swap_sizes = true;
-                break;
-            case ns::deg180:
-                draw_indent = 2 * drawing_plane_vert_count;
-                swap_sizes = false;
-                break;
-            case ns::deg270:
-                draw_indent = 3 * drawing_plane_vert_count;
-                swap_sizes = true;
-                break;
-            default:
-                break;
+        BNB_OEP_TRACE_SCOPE("ort", "orient_image");
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->end();
         }
 
-        if (m_swap_sizes != swap_sizes) {
-            m_swap_sizes = swap_sizes;
-            delete_postprocessing_texture();
+        auto& buffer = m_buffers[m_current_buffer];
+        bool swap_sizes = is_rotated_by_90(orient);
+        if (buffer.swap_sizes != swap_sizes) {
+            buffer.swap_sizes = swap_sizes;
+            delete_postprocessing_texture(buffer);
         }
 
-        prepare_post_processing_rendering();
-        m_shader->use();
-        /* bind drawing geometry */
-        glBindVertexArray(m_vao);
-        glDrawArrays(GL_TRIANGLE_STRIP, draw_indent, drawing_plane_vert_count);
-        glBindVertexArray(0);
-        m_shader->unuse();
+        /* the YUV conversion and the pixel packing apply the orientation while reading the render texture,
+        so the post processing pass is rendered only if the texture is requested */
+        buffer.orientation = orient;
+        buffer.deferred_orientation = orient;
 
-        GL_CALL(glFlush());
+        /* start the transfer of the frame in the format requested for the previous frames, so by the time
+        of read_current_buffer() call the GPU has likely finished it and the render thread does not stall */
+        if (m_readback_format_hint.has_value()) {
+            issue_readback(buffer, {*m_readback_format_hint, orient});
+        }
+        submit_readbacks(buffer);
+    }
+
+    /* offscreen_render_target::prefetch */
+    void offscreen_render_target::prefetch(const std::vector<bnb::oep::interfaces::output_spec>& outputs)
+    {
+        BNB_OEP_TRACE_SCOPE("ort", "prefetch");
+        auto& buffer = m_buffers[m_current_buffer];
+        bool issued = false;
+        for (const auto& requested : outputs) {
+            auto output = normalize_output(requested);
+            if (find_image(buffer, output) == nullptr && !has_readback(buffer, output)) {
+                issued = issue_readback(buffer, output) || issued;
+            }
+        }
+        /* the passes of all the outputs are submitted together */
+        if (issued) {
+            submit_readbacks(buffer);
+        }
     }
 
     /* offscreen_render_target::read_current_buffer */
     pixel_buffer_sptr offscreen_render_target::read_current_buffer(bnb::oep::interfaces::image_format format)
     {
+        /* the same format is expected to be requested for the next frames */
+        m_readback_format_hint = format;
+        return read_current_buffer({format, m_buffers[m_current_buffer].orientation});
+    }
+
+    /* offscreen_render_target::read_current_buffer */
+    pixel_buffer_sptr offscreen_render_target::read_current_buffer(const bnb::oep::interfaces::output_spec& requested)
+    {
+        BNB_OEP_TRACE_SCOPE("ort", "read_current_buffer");
         activate_context();
 
+        auto& buffer = m_buffers[m_current_buffer];
+        /* the output of the size of the rendered image is the same as without the size */
+        auto output = normalize_output(requested);
+        /* the image was already read by another consumer of the frame */
+        if (auto image = find_image(buffer, output)) {
+            return image;
+        }
+
+        pixel_buffer_sptr image;
+        if (!has_readback(buffer, output)) {
+            image = derive_image(buffer, output);
+            /* usually the readback is already issued right after orient_image(), otherwise issue it now */
+            if (image == nullptr && !issue_readback(buffer, output)) {
+                return nullptr;
+            }
+        }
+        if (image == nullptr) {
+            image = read_current_buffer(buffer, output, false);
+        }
+        if (image != nullptr) {
+            buffer.images.push_back({output, image});
+        }
+        return image;
+    }
+
+    /* offscreen_render_target::read_current_buffer */
+    bool offscreen_render_target::read_current_buffer(pixel_buffer_sptr destination)
+    {
+        BNB_OEP_TRACE_SCOPE("ort", "read_current_buffer_into");
+        if (destination == nullptr) {
+            return false;
+        }
+
+        auto& buffer = m_buffers[m_current_buffer];
+        int32_t width = buffer.swap_sizes ? m_height : m_width;
+        int32_t height = buffer.swap_sizes ? m_width : m_height;
+        if (destination->get_width() != width || destination->get_height() != height) {
+            std::cout << "[WARNING] The sizes of the destination pixel buffer differ from the sizes of the rendered image" << std::endl;
+            return false;
+        }
+
+        bnb::oep::interfaces::output_spec output{destination->get_image_format(), buffer.orientation};
+        m_readback_format_hint = output.format;
+        if (auto image = find_image(buffer, output)) {
+            return bnb::oep::memory::copy_planes(*image, *destination);
+        }
+
+        activate_context();
+        if (!has_readback(buffer, output) && !issue_readback(buffer, output)) {
+            return false;
+        }
+
+        /* the rows are copied from the mapped readback buffer straight into the destination,
+        the mapped image is released before the return */
+        auto image = read_current_buffer(buffer, output, true);
+        return image != nullptr && bnb::oep::memory::copy_planes(*image, *destination);
+    }
+
+    /* offscreen_render_target::read_current_buffer */
+    pixel_buffer_sptr offscreen_render_target::read_current_buffer(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place)
+    {
         using ns = bnb::oep::interfaces::image_format;
-        switch (format) {
+        switch (output.format) {
             case ns::bpc8_rgb:
             case ns::bpc8_bgr:
             case ns::bpc8_rgba:
             case ns::bpc8_bgra:
             case ns::bpc8_argb:
-                return read_current_buffer_bpc8(format);
+                return read_current_buffer_bpc8(buffer, output, in_place);
                 break;
             case ns::i420_bt601_full:
             case ns::i420_bt601_video:
             case ns::i420_bt709_full:
             case ns::i420_bt709_video:
-                return read_current_buffer_i420(format);
+                return read_current_buffer_i420(buffer, output, in_place);
+                break;
+            case ns::nv12_bt601_full:
+            case ns::nv12_bt601_video:
+            case ns::nv12_bt709_full:
+            case ns::nv12_bt709_video:
+                return read_current_buffer_nv12(buffer, output, in_place);
                 break;
             default:
                 return nullptr;
@@ -238,7 +422,9 @@ namespace bnb::oep
     /* offscreen_render_target::get_current_buffer_texture */
     rendered_texture_t offscreen_render_target::get_current_buffer_texture()
     {
-        return reinterpret_cast<rendered_texture_t>(m_active_texture);
+        auto& buffer = m_buffers[m_current_buffer];
+        apply_deferred_orientation(buffer);
+        return reinterpret_cast<rendered_texture_t>(buffer.active_texture);
     }
 
     /* offscreen_render_target::generate_texture */
@@ -257,31 +443,44 @@ namespace bnb::oep
     /* offscreen_render_target::delete_textures */
     void offscreen_render_target::delete_textures()
     {
-        if (m_offscreen_render_texture != 0) {
-            GL_CALL(glDeleteTextures(1, &m_offscreen_render_texture));
-            m_offscreen_render_texture = 0;
+        for (auto& buffer : m_buffers) {
+            delete_textures(buffer);
         }
-        delete_postprocessing_texture();
+    }
+
+    /* offscreen_render_target::delete_textures */
+    void offscreen_render_target::delete_textures(render_buffer& buffer)
+    {
+        if (buffer.render_texture != 0) {
+            GL_CALL(glDeleteTextures(1, &buffer.render_texture));
+            buffer.render_texture = 0;
+        }
+        delete_postprocessing_texture(buffer);
+        buffer.active_texture = 0;
+        buffer.swap_sizes = false;
+        buffer.deferred_orientation.reset();
+        release_readbacks(buffer);
+        buffer.images.clear();
     }
 
     /* offscreen_render_target::delete_postprocessing_texture */
-    void offscreen_render_target::delete_postprocessing_texture() {
-        if (m_offscreen_post_processuing_render_texture != 0) {
-            GL_CALL(glDeleteTextures(1, &m_offscreen_post_processuing_render_texture));
-            m_offscreen_post_processuing_render_texture = 0;
+    void offscreen_render_target::delete_postprocessing_texture(render_buffer& buffer) {
+        if (buffer.post_processing_texture != 0) {
+            GL_CALL(glDeleteTextures(1, &buffer.post_processing_texture));
+            buffer.post_processing_texture = 0;
         }
     }
 
     /* offscreen_render_target::prepare_post_processing_rendering */
-    void offscreen_render_target::prepare_post_processing_rendering()
+    void offscreen_render_target::prepare_post_processing_rendering(render_buffer& buffer)
     {
-        int32_t width = m_swap_sizes ? m_height : m_width;
-        int32_t height = m_swap_sizes ? m_width : m_height;
-        if (m_offscreen_post_processuing_render_texture == 0) {
-            generate_texture(m_offscreen_post_processuing_render_texture, width, height);
+        int32_t width = buffer.swap_sizes ? m_height : m_width;
+        int32_t height = buffer.swap_sizes ? m_width : m_height;
+        if (buffer.post_processing_texture == 0) {
+            generate_texture(buffer.post_processing_texture, width, height);
         }
         GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_post_processing_framebuffer));
-        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_offscreen_post_processuing_render_texture, 0));
+        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer.post_processing_texture, 0));
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
             GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -292,112 +491,579 @@ namespace bnb::oep
         GL_CALL(glViewport(0, 0, GLsizei(width), GLsizei(height)));
 
         GL_CALL(glActiveTexture(GLenum(GL_TEXTURE0)));
-        GL_CALL(glBindTexture(GL_TEXTURE_2D, m_offscreen_render_texture));
-        m_active_texture = m_offscreen_post_processuing_render_texture;
-        m_last_framebuffer = m_post_processing_framebuffer;
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, buffer.render_texture));
+        buffer.active_texture = buffer.post_processing_texture;
         GL_CALL(glDisable(GL_CULL_FACE));
     }
 
-    /* offscreen_render_target::read_current_buffer_bpc8 */
-    pixel_buffer_sptr offscreen_render_target::read_current_buffer_bpc8(bnb::oep::interfaces::image_format format_hint)
+    /* offscreen_render_target::apply_deferred_orientation */
+    void offscreen_render_target::apply_deferred_orientation(render_buffer& buffer)
+    {
+        if (!buffer.deferred_orientation.has_value() || buffer.render_texture == 0) {
+            return;
+        }
+        /* the geometry variants are stored in the order of the rotation values */
+        int32_t draw_indent = static_cast<int32_t>(*buffer.deferred_orientation) * drawing_plane_vert_count;
+        buffer.deferred_orientation.reset();
+
+        BNB_OEP_TRACE_SCOPE("ort", "post_processing");
+        prepare_post_processing_rendering(buffer);
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->begin(static_cast<int32_t>(bnb::oep::interfaces::frame_stage::gpu_orient_image));
+        }
+        m_shader->use();
+        /* bind drawing geometry */
+        glBindVertexArray(m_vao);
+        glDrawArrays(GL_TRIANGLE_STRIP, draw_indent, drawing_plane_vert_count);
+        glBindVertexArray(0);
+        m_shader->unuse();
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->end();
+        }
+    }
+
+    /* offscreen_render_target::bind_readback_framebuffer */
+    void offscreen_render_target::bind_readback_framebuffer(GLuint texture)
     {
-        int32_t width = m_swap_sizes ? m_height : m_width;
-        int32_t height = m_swap_sizes ? m_width : m_height;
+        /* frames of the previous buffers are not attached to any framebuffer anymore,
+        so the texture is attached to the separate framebuffer used for reading only */
+        GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_readback_framebuffer));
+        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0));
+    }
+
+    /* offscreen_render_target::issue_readback */
+    bool offscreen_render_target::issue_readback(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output)
+    {
+        BNB_OEP_TRACE_SCOPE("ort", "issue_readback");
+        if (buffer.active_texture == 0) {
+            return false;
+        }
+
+        auto [width, height] = get_output_size(output);
+        /* the outputs of the other orientations are converted from the render texture, which is never changed
+        by the post processing, so one rendered frame gives the outputs of any orientations */
+        std::optional<bnb::oep::interfaces::rotation> orientation;
+        if (buffer.deferred_orientation.has_value() || output.orientation != buffer.orientation) {
+            orientation = output.orientation;
+        }
+        int32_t readback_index = acquire_readback_slot();
+        auto& readback = *m_readback_ring[readback_index].buffer;
+        GLuint oriented_texture = buffer.active_texture;
+        if (output.width != 0) {
+            /* the resampled image is oriented in the same way as by the orientation pass */
+            auto& resampler = get_resampler(output.filter);
+            resampler.set_drawing_orientation(static_cast<bnb::oep::converter::resampler::rotation>(output.orientation));
+            oriented_texture = resampler.resample(static_cast<uint32_t>(buffer.render_texture), m_width, m_height, width, height);
+            orientation.reset();
+        }
+
         using ns = bnb::oep::interfaces::image_format;
-        int32_t pixel_size{0};
-        GLenum gl_format{0};
-        switch (format_hint) {
+        switch (output.format) {
             case ns::bpc8_rgb:
-                pixel_size = 3;
-                gl_format = GL_RGB;
-                break;
-
-#if defined(GL_BGR)
             case ns::bpc8_bgr:
-                pixel_size = 3;
-                gl_format = GL_BGR;
-                break;
-#endif /* defined(GL_BGR) */
-
             case ns::bpc8_rgba:
-                pixel_size = 4;
-                gl_format = GL_RGBA;
-                break;
-
-#if defined(GL_BGRA)
             case ns::bpc8_bgra:
-                pixel_size = 4;
-                gl_format = GL_BGRA;
-                break;
-#endif /* defined(GL_BGRA) */
-
+            case ns::bpc8_argb: {
+                auto& converter = get_bpc8_converter(output.format);
+                if (orientation.has_value()) {
+                    /* the same geometry as of the YUV conversion, the packing pass replaces the post processing pass */
+                    converter.set_drawing_orientation(static_cast<bnb::oep::converter::bpc8_converter::rotation>(*orientation), false);
+                    converter.convert(static_cast<uint32_t>(buffer.render_texture), width, height, readback);
+                } else if (output.format == ns::bpc8_rgba) {
+                    /* the texture is already oriented and has the requested layout, so it is read as is */
+                    bind_readback_framebuffer(oriented_texture);
+                    readback.read_pixels(width, height, GL_RGBA, converter.calc_min_data_size(width, height));
+                    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+                } else {
+                    converter.set_drawing_orientation(bnb::oep::converter::bpc8_converter::rotation::deg_0, true);
+                    converter.convert(static_cast<uint32_t>(oriented_texture), width, height, readback);
+                }
+            } break;
+            case ns::nv12_bt601_full:
+            case ns::nv12_bt601_video:
+            case ns::nv12_bt709_full:
+            case ns::nv12_bt709_video:
+            case ns::i420_bt601_full:
+            case ns::i420_bt601_video:
+            case ns::i420_bt709_full:
+            case ns::i420_bt709_video:
+            {
+                auto& converter = get_yuv_converter(output.format);
+                if (orientation.has_value()) {
+                    /* the not flipped geometry of the converter is the same as of the post processing pass,
+                    so the rotated image is converted in one pass without the intermediate texture */
+                    converter.set_drawing_orientation(static_cast<bnb::oep::converter::yuv_converter::rotation>(*orientation), false);
+                    converter.convert(static_cast<uint32_t>(buffer.render_texture), width, height, readback);
+                } else {
+                    converter.set_drawing_orientation(bnb::oep::converter::yuv_converter::rotation::deg_0, true);
+                    converter.convert(static_cast<uint32_t>(oriented_texture), width, height, readback);
+                }
+            } break;
             default:
-                return nullptr;
+                m_readback_ring[readback_index].state->in_use = false;
+                return false;
         }
+        buffer.readbacks.push_back({output, readback_index});
+        return true;
+    }
 
-        size_t size = width * height * 4;
-        auto plane_storage = std::shared_ptr<uint8_t>(new uint8_t[size]);
-        bnb::oep::interfaces::pixel_buffer::plane_data bpc8_plane{plane_storage, size, width * 4};
+    /* offscreen_render_target::submit_readbacks */
+    void offscreen_render_target::submit_readbacks(render_buffer& buffer)
+    {
+        /* one fence after the last readback is signaled after all of them */
+        pixel_pack_buffer::fence_sptr fence;
+        for (const auto& readback : buffer.readbacks) {
+            auto& pack_buffer = *m_readback_ring[readback.index].buffer;
+            if (!pack_buffer.is_fenced()) {
+                if (fence == nullptr) {
+                    fence = pixel_pack_buffer::insert_fence();
+                }
+                pack_buffer.set_fence(fence);
+            }
+        }
+        /* submit the commands, otherwise the fence may be signaled only when waited for */
+        GL_CALL(glFlush());
+    }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, m_last_framebuffer);
-        GL_CALL(glReadPixels(0, 0, width, height, gl_format, GL_UNSIGNED_BYTE, plane_storage.get()));
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    /* offscreen_render_target::find_image */
+    pixel_buffer_sptr offscreen_render_target::find_image(const render_buffer& buffer, const bnb::oep::interfaces::output_spec& output) const
+    {
+        for (const auto& cached : buffer.images) {
+            if (cached.output == output) {
+                return cached.image;
+            }
+        }
+        return nullptr;
+    }
 
-        std::vector<bnb::oep::interfaces::pixel_buffer::plane_data> planes{bpc8_plane};
-        return bnb::oep::interfaces::pixel_buffer::create(planes, format_hint, width, height);
+    /* offscreen_render_target::derive_image */
+    pixel_buffer_sptr offscreen_render_target::derive_image(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output)
+    {
+        /* nv12 and i420 of the same color standard differ only in the layout of the chroma,
+        so the image is derived from the cached one with the same Y plane and rearranged U and V */
+        using ns = bnb::oep::interfaces::image_format;
+        auto format = output.format;
+        bool to_nv12 = format >= ns::nv12_bt601_full && format <= ns::nv12_bt709_video;
+        bool to_i420 = format >= ns::i420_bt601_full && format <= ns::i420_bt709_video;
+        if (!to_nv12 && !to_i420) {
+            return nullptr;
+        }
+        auto standard = static_cast<int32_t>(format) - static_cast<int32_t>(to_nv12 ? ns::nv12_bt601_full : ns::i420_bt601_full);
+        auto source_output = output;
+        source_output.format = static_cast<ns>(static_cast<int32_t>(to_nv12 ? ns::i420_bt601_full : ns::nv12_bt601_full) + standard);
+        auto source = find_image(buffer, source_output);
+        if (source == nullptr) {
+            return nullptr;
+        }
+        BNB_OEP_TRACE_SCOPE("ort", "derive_image");
+
+        using ns_pb = bnb::oep::interfaces::pixel_buffer;
+        int32_t width = source->get_width();
+        int32_t height = source->get_height();
+        int32_t chroma_width = source->get_width_of_plane(1);
+        int32_t chroma_height = source->get_height_of_plane(1);
+        int32_t y_stride = source->get_bytes_per_row_of_plane(0);
+        ns_pb::plane_data y_plane{source->get_base_sptr_of_plane(0), static_cast<size_t>(y_stride) * height, y_stride};
+
+        if (to_nv12) {
+            int32_t uv_stride = (chroma_width * 2 + 3) & ~3;
+            size_t uv_size = static_cast<size_t>(uv_stride) * chroma_height;
+            auto uv_data = m_buffer_pool->acquire(uv_size);
+            for (int32_t y = 0; y < chroma_height; ++y) {
+                const uint8_t* u = source->get_base_sptr_of_plane(1).get() + static_cast<size_t>(y) * source->get_bytes_per_row_of_plane(1);
+                const uint8_t* v = source->get_base_sptr_of_plane(2).get() + static_cast<size_t>(y) * source->get_bytes_per_row_of_plane(2);
+                uint8_t* uv = uv_data.get() + static_cast<size_t>(y) * uv_stride;
+                for (int32_t x = 0; x < chroma_width; ++x) {
+                    uv[2 * x] = u[x];
+                    uv[2 * x + 1] = v[x];
+                }
+            }
+            std::vector<ns_pb::plane_data> planes{y_plane, {uv_data, uv_size, uv_stride}};
+            return ns_pb::create(planes, format, width, height);
+        }
+
+        int32_t chroma_stride = (chroma_width + 3) & ~3;
+        size_t chroma_size = static_cast<size_t>(chroma_stride) * chroma_height;
+        auto chroma_data = m_buffer_pool->acquire(chroma_size * 2);
+        ns_pb::plane_sptr u_data(chroma_data, chroma_data.get());
+        ns_pb::plane_sptr v_data(chroma_data, chroma_data.get() + chroma_size);
+        for (int32_t y = 0; y < chroma_height; ++y) {
+            const uint8_t* uv = source->get_base_sptr_of_plane(1).get() + static_cast<size_t>(y) * source->get_bytes_per_row_of_plane(1);
+            uint8_t* u = u_data.get() + static_cast<size_t>(y) * chroma_stride;
+            uint8_t* v = v_data.get() + static_cast<size_t>(y) * chroma_stride;
+            for (int32_t x = 0; x < chroma_width; ++x) {
+                u[x] = uv[2 * x];
+                v[x] = uv[2 * x + 1];
+            }
+        }
+        std::vector<ns_pb::plane_data> planes{y_plane, {u_data, chroma_size, chroma_stride}, {v_data, chroma_size, chroma_stride}};
+        return ns_pb::create(planes, format, width, height);
     }
 
-    /* offscreen_render_target::read_current_buffer_i420 */
-    pixel_buffer_sptr offscreen_render_target::read_current_buffer_i420(bnb::oep::interfaces::image_format format_hint)
+    /* offscreen_render_target::has_readback */
+    bool offscreen_render_target::has_readback(const render_buffer& buffer, const bnb::oep::interfaces::output_spec& output) const
+    {
+        for (const auto& readback : buffer.readbacks) {
+            if (readback.output == output) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* offscreen_render_target::acquire_readback_slot */
+    int32_t offscreen_render_target::acquire_readback_slot()
+    {
+        for (size_t i = 0; i < m_readback_ring.size(); ++i) {
+            size_t index = (m_next_readback_slot + i) % m_readback_ring.size();
+            bool expected{false};
+            if (m_readback_ring[index].state->in_use.compare_exchange_strong(expected, true)) {
+                m_next_readback_slot = (index + 1) % m_readback_ring.size();
+                return static_cast<int32_t>(index);
+            }
+        }
+
+        /* every slot is either pending or still referenced by a pixel buffer, so the ring grows */
+        if (m_readback_ring.size() >= readback_ring_max_size) {
+            /* the images cached for the other buffers may keep the slots, they are read again if requested */
+            bool released = false;
+            for (size_t i = 0; i < m_buffers.size(); ++i) {
+                if (i != m_current_buffer && !m_buffers[i].images.empty()) {
+                    m_buffers[i].images.clear();
+                    released = true;
+                }
+            }
+            if (released) {
+                return acquire_readback_slot();
+            }
+            /* the pixel data of the slot is copied into the pool on mapping, so the slot is never held by the pixel
+            buffers and is free again right after the image is read */
+            m_readback_ring.push_back({std::make_unique<pixel_pack_buffer>(false), std::make_shared<readback_slot_state>()});
+            m_next_readback_slot = 0;
+            return static_cast<int32_t>(m_readback_ring.size() - 1);
+        }
+        /* pixel buffers point directly into the persistently mapped memory when it is supported */
+        m_readback_ring.push_back({std::make_unique<pixel_pack_buffer>(true), std::make_shared<readback_slot_state>()});
+        m_next_readback_slot = 0;
+        return static_cast<int32_t>(m_readback_ring.size() - 1);
+    }
+
+    /* offscreen_render_target::release_readbacks */
+    void offscreen_render_target::release_readbacks(render_buffer& buffer)
+    {
+        for (const auto& readback : buffer.readbacks) {
+            auto& slot = m_readback_ring[readback.index];
+            slot.buffer->discard();
+            slot.state->in_use = false;
+        }
+        /* the capacity is kept, so issuing the readbacks of the next frames does not allocate */
+        buffer.readbacks.clear();
+    }
+
+    /* offscreen_render_target::retain_held_readbacks */
+    std::shared_ptr<void> offscreen_render_target::retain_held_readbacks()
+    {
+        /* only the persistently mapped slots are referenced by the pixel data after all the readbacks are released */
+        std::vector<std::unique_ptr<pixel_pack_buffer>> buffers;
+        std::vector<std::shared_ptr<readback_slot_state>> states;
+        for (auto& slot : m_readback_ring) {
+            if (slot.buffer->is_persistent() && slot.state->in_use) {
+                buffers.push_back(std::move(slot.buffer));
+                states.push_back(slot.state);
+            }
+        }
+        if (buffers.empty()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<void> retained = std::make_shared<retained_readbacks>(m_rc, std::move(buffers));
+        for (auto& state : states) {
+            std::atomic_store(&state->keep_alive, retained);
+            /* the pixel data may be released before the store, then the deleter has not reset it */
+            if (!state->in_use) {
+                std::atomic_exchange(&state->keep_alive, std::shared_ptr<void>());
+            }
+        }
+        return retained;
+    }
+
+    /* offscreen_render_target::map_readback */
+    std::shared_ptr<uint8_t> offscreen_render_target::map_readback(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, size_t size, bool in_place)
+    {
+        auto it = std::find_if(buffer.readbacks.begin(), buffer.readbacks.end(), [&output](const pending_readback& readback) {
+            return readback.output == output;
+        });
+        if (it == buffer.readbacks.end()) {
+            return nullptr;
+        }
+        auto& slot = m_readback_ring[it->index];
+        buffer.readbacks.erase(it);
+
+        /* waits for the GPU only if it has not finished the readback yet */
+        const uint8_t* data{nullptr};
+        {
+            BNB_OEP_TRACE_SCOPE("ort", "wait_readback");
+            data = slot.buffer->map();
+        }
+        if (data == nullptr) {
+            slot.state->in_use = false;
+            return nullptr;
+        }
+
+        if (slot.buffer->is_persistent()) {
+            /* no copy, the slot is released together with the last reference to the pixel data.
+            The memory is mapped for reading only, deinit() keeps it mapped while the data is referenced */
+            return std::shared_ptr<uint8_t>(const_cast<uint8_t*>(data), [state = slot.state](uint8_t*) {
+                state->in_use = false;
+                std::atomic_exchange(&state->keep_alive, std::shared_ptr<void>());
+            });
+        }
+
+        if (in_place) {
+            /* no copy, the caller releases the data on the render thread before the next use of the buffer */
+            return std::shared_ptr<uint8_t>(const_cast<uint8_t*>(data), [pack_buffer = slot.buffer.get(), state = slot.state](uint8_t*) {
+                pack_buffer->unmap();
+                state->in_use = false;
+            });
+        }
+
+        BNB_OEP_TRACE_SCOPE("ort", "copy_readback");
+        auto storage = m_buffer_pool->acquire(size);
+        std::memcpy(storage.get(), data, size);
+        slot.buffer->unmap();
+        slot.state->in_use = false;
+        return storage;
+    }
+
+    /* offscreen_render_target::set_gpu_timers_enabled */
+    void offscreen_render_target::set_gpu_timers_enabled(bool enabled)
+    {
+        if (enabled && m_gpu_timer == nullptr) {
+            if (!gpu_timer::is_supported()) {
+                std::cout << "[WARNING] GPU timer queries are not supported." << std::endl;
+                return;
+            }
+            m_gpu_timer = std::make_unique<gpu_timer>();
+        } else if (!enabled) {
+            m_gpu_timer.reset();
+        }
+        if (m_yuv_i420_converter != nullptr) {
+            attach_gpu_timer(*m_yuv_i420_converter);
+        }
+        if (m_yuv_nv12_converter != nullptr) {
+            attach_gpu_timer(*m_yuv_nv12_converter);
+        }
+        if (m_bpc8_converter != nullptr) {
+            attach_gpu_timer(*m_bpc8_converter);
+        }
+        if (m_resampler != nullptr) {
+            attach_gpu_timer(*m_resampler);
+        }
+    }
+
+    /* offscreen_render_target::collect_gpu_timings */
+    void offscreen_render_target::collect_gpu_timings(const oep_gpu_timing_cb& callback)
+    {
+        if (m_gpu_timer == nullptr) {
+            return;
+        }
+        m_gpu_timer->collect([&callback](int32_t tag, int64_t duration_ns) {
+            callback(static_cast<bnb::oep::interfaces::frame_stage>(tag), duration_ns);
+        });
+    }
+
+    /* offscreen_render_target::allocate_buffer */
+    std::shared_ptr<uint8_t> offscreen_render_target::allocate_buffer(size_t size)
+    {
+        return m_buffer_pool->acquire(size);
+    }
+
+    /* offscreen_render_target::set_buffer_pool_limits */
+    void offscreen_render_target::set_buffer_pool_limits(size_t max_cached_bytes, size_t max_buffers_per_size)
+    {
+        m_buffer_pool->set_limits(max_cached_bytes, max_buffers_per_size);
+    }
+
+    /* offscreen_render_target::trim_buffer_pool */
+    void offscreen_render_target::trim_buffer_pool()
+    {
+        m_buffer_pool->trim();
+    }
+
+    /* offscreen_render_target::attach_gpu_timer */
+    void offscreen_render_target::attach_gpu_timer(bnb::oep::converter::yuv_converter& converter)
+    {
+        using ns = bnb::oep::interfaces::frame_stage;
+        converter.set_gpu_timer(
+            m_gpu_timer.get(),
+            static_cast<int32_t>(ns::gpu_yuv_y_plane),
+            static_cast<int32_t>(ns::gpu_yuv_u_plane),
+            static_cast<int32_t>(ns::gpu_yuv_v_plane));
+    }
+
+    /* offscreen_render_target::attach_gpu_timer */
+    void offscreen_render_target::attach_gpu_timer(bnb::oep::converter::bpc8_converter& converter)
+    {
+        converter.set_gpu_timer(m_gpu_timer.get(), static_cast<int32_t>(bnb::oep::interfaces::frame_stage::gpu_pack_pixels));
+    }
+
+    /* offscreen_render_target::attach_gpu_timer */
+    void offscreen_render_target::attach_gpu_timer(bnb::oep::converter::resampler& resampler)
+    {
+        resampler.set_gpu_timer(m_gpu_timer.get(), static_cast<int32_t>(bnb::oep::interfaces::frame_stage::gpu_resample));
+    }
+
+    /* offscreen_render_target::get_yuv_converter */
+    bnb::oep::converter::yuv_converter& offscreen_render_target::get_yuv_converter(bnb::oep::interfaces::image_format format)
     {
-        int32_t width = m_swap_sizes ? m_height : m_width;
-        int32_t height = m_swap_sizes ? m_width : m_height;
         using ns = bnb::oep::interfaces::image_format;
         using ns_cvt = bnb::oep::converter::yuv_converter;
         ns_cvt::standard std{ns_cvt::standard::bt601};
         ns_cvt::range rng{ns_cvt::range::full_range};
-        switch (format_hint) {
-            case ns::i420_bt601_full:
-                break;
+        switch (format) {
             case ns::i420_bt601_video:
+            case ns::nv12_bt601_video:
                 rng = ns_cvt::range::video_range;
                 break;
             case ns::i420_bt709_full:
+            case ns::nv12_bt709_full:
                 std = ns_cvt::standard::bt709;
                 break;
             case ns::i420_bt709_video:
+            case ns::nv12_bt709_video:
                 std = ns_cvt::standard::bt709;
                 rng = ns_cvt::range::video_range;
                 break;
             default:
-                return nullptr;
+                break;
+        }
+
+        /* the layout is defined by the converter, so nv12 and i420 have separate ones */
+        bool is_nv12 = format == ns::nv12_bt601_full || format == ns::nv12_bt601_video || format == ns::nv12_bt709_full || format == ns::nv12_bt709_video;
+        auto& converter = is_nv12 ? m_yuv_nv12_converter : m_yuv_i420_converter;
+        if (converter == nullptr) {
+            auto layout = is_nv12 ? ns_cvt::yuv_data_layout::semi_planar_layout : ns_cvt::yuv_data_layout::planar_layout;
+            converter = std::make_unique<ns_cvt>(std, rng, ns_cvt::rotation::deg_0, false, layout);
+            attach_gpu_timer(*converter);
+        }
+
+        converter->set_convert_standard(std, rng);
+        return *converter;
+    }
+
+    /* offscreen_render_target::get_bpc8_converter */
+    bnb::oep::converter::bpc8_converter& offscreen_render_target::get_bpc8_converter(bnb::oep::interfaces::image_format format)
+    {
+        using ns = bnb::oep::interfaces::image_format;
+        using ns_cvt = bnb::oep::converter::bpc8_converter;
+        ns_cvt::pixel_layout layout{ns_cvt::pixel_layout::rgba};
+        switch (format) {
+            case ns::bpc8_rgb:
+                layout = ns_cvt::pixel_layout::rgb;
+                break;
+            case ns::bpc8_bgr:
+                layout = ns_cvt::pixel_layout::bgr;
+                break;
+            case ns::bpc8_bgra:
+                layout = ns_cvt::pixel_layout::bgra;
+                break;
+            case ns::bpc8_argb:
+                layout = ns_cvt::pixel_layout::argb;
+                break;
+            default:
+                break;
         }
 
-        if (m_yuv_i420_converter == nullptr) {
-            m_yuv_i420_converter = std::make_unique<bnb::oep::converter::yuv_converter>();
-            m_yuv_i420_converter->set_drawing_orientation(ns_cvt::rotation::deg_0, true);
+        if (m_bpc8_converter == nullptr) {
+            m_bpc8_converter = std::make_unique<ns_cvt>(layout);
+            attach_gpu_timer(*m_bpc8_converter);
         }
 
-        m_yuv_i420_converter->set_convert_standard(std, rng);
+        m_bpc8_converter->set_pixel_layout(layout);
+        return *m_bpc8_converter;
+    }
 
-        auto do_nothing_deleter_uint8 = [](uint8_t*) { /* DO NOTHING */ };
-        auto default_deleter_uint8 = std::default_delete<uint8_t>();
+    /* offscreen_render_target::get_resampler */
+    bnb::oep::converter::resampler& offscreen_render_target::get_resampler(bnb::oep::interfaces::resample_filter filter)
+    {
+        using ns_cvt = bnb::oep::converter::resampler;
+        /* the filters have the same order */
+        auto resampler_filter = static_cast<ns_cvt::filter>(filter);
+        if (m_resampler == nullptr) {
+            m_resampler = std::make_unique<ns_cvt>(resampler_filter);
+            attach_gpu_timer(*m_resampler);
+        }
+
+        m_resampler->set_filter(resampler_filter);
+        return *m_resampler;
+    }
+
+    /* offscreen_render_target::normalize_output */
+    bnb::oep::interfaces::output_spec offscreen_render_target::normalize_output(const bnb::oep::interfaces::output_spec& output) const
+    {
+        int32_t width = is_rotated_by_90(output.orientation) ? m_height : m_width;
+        int32_t height = is_rotated_by_90(output.orientation) ? m_width : m_height;
+        bnb::oep::interfaces::output_spec normalized{output.format, output.orientation};
+        /* the zero sizes and the sizes of the rendered image do not need the resampling, so the filter does not matter */
+        if (output.width > 0 && output.height > 0 && (output.width != width || output.height != height)) {
+            normalized.width = output.width;
+            normalized.height = output.height;
+            normalized.filter = output.filter;
+        }
+        return normalized;
+    }
+
+    /* offscreen_render_target::get_output_size */
+    std::pair<int32_t, int32_t> offscreen_render_target::get_output_size(const bnb::oep::interfaces::output_spec& output) const
+    {
+        if (output.width != 0) {
+            return {output.width, output.height};
+        }
+        return {is_rotated_by_90(output.orientation) ? m_height : m_width, is_rotated_by_90(output.orientation) ? m_width : m_height};
+    }
+
+    /* offscreen_render_target::read_current_buffer_bpc8 */
+    pixel_buffer_sptr offscreen_render_target::read_current_buffer_bpc8(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place)
+    {
+        auto format_hint = output.format;
+        auto [width, height] = get_output_size(output);
+        auto& converter = get_bpc8_converter(format_hint);
+        /* rows are aligned to four bytes, so the 3-byte formats may have padding at the end of the row */
+        int32_t bytes_per_row = converter.calc_bytes_per_row(width);
+        size_t size = converter.calc_min_data_size(width, height);
+
+        auto plane_storage = map_readback(buffer, output, size, in_place);
+        if (plane_storage == nullptr) {
+            return nullptr;
+        }
+
+        bnb::oep::interfaces::pixel_buffer::plane_data bpc8_plane{plane_storage, size, bytes_per_row};
+        std::vector<bnb::oep::interfaces::pixel_buffer::plane_data> planes{bpc8_plane};
+        return bnb::oep::interfaces::pixel_buffer::create(planes, format_hint, width, height);
+    }
+
+    /* offscreen_render_target::read_current_buffer_i420 */
+    pixel_buffer_sptr offscreen_render_target::read_current_buffer_i420(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place)
+    {
+        auto format_hint = output.format;
+        auto [width, height] = get_output_size(output);
+        using ns_cvt = bnb::oep::converter::yuv_converter;
 
         ns_cvt::yuv_data i420_planes_data;
-        /* allocate needed memory for store */
         int32_t clamped_width = (width + 7) & ~7; /* alhoritm specific */
         i420_planes_data.size = m_yuv_i420_converter->calc_min_yuv_data_size(width, height);
-        i420_planes_data.data = std::shared_ptr<uint8_t>(new uint8_t[i420_planes_data.size], do_nothing_deleter_uint8);
 
-        /* convert to i420 */
-        uint32_t gl_texture = static_cast<uint32_t>(reinterpret_cast<uint64_t>(get_current_buffer_texture()));
-        m_yuv_i420_converter->convert(gl_texture, width, height, i420_planes_data);
+        i420_planes_data.data = map_readback(buffer, output, i420_planes_data.size, in_place);
+        if (i420_planes_data.data == nullptr) {
+            return nullptr;
+        }
+        m_yuv_i420_converter->fill_yuv_data_planes(i420_planes_data.data.get(), width, height, i420_planes_data);
 
-        /* save data */
+        /* save data, the U and V planes share the ownership of the Y plane memory */
         using ns_pb = bnb::oep::interfaces::pixel_buffer;
-        ns_pb::plane_sptr y_plane_data(i420_planes_data.y_plane_data, do_nothing_deleter_uint8);
-        ns_pb::plane_sptr u_plane_data(i420_planes_data.u_plane_data, do_nothing_deleter_uint8);
-        ns_pb::plane_sptr v_plane_data(i420_planes_data.v_plane_data, do_nothing_deleter_uint8);
+        ns_pb::plane_sptr y_plane_data(i420_planes_data.data, i420_planes_data.y_plane_data);
+        ns_pb::plane_sptr u_plane_data(i420_planes_data.data, i420_planes_data.u_plane_data);
+        ns_pb::plane_sptr v_plane_data(i420_planes_data.data, i420_planes_data.v_plane_data);
         size_t y_plane_size(static_cast<size_t>(i420_planes_data.u_plane_data - i420_planes_data.y_plane_data));
         size_t v_u_planes_diff(static_cast<size_t>(i420_planes_data.v_plane_data - i420_planes_data.u_plane_data));
         size_t u_plane_size(i420_planes_data.size - y_plane_size - v_u_planes_diff);
@@ -408,7 +1074,38 @@ namespace bnb::oep
 
         std::vector<ns_pb::plane_data> planes{y_plane, u_plane, v_plane};
 
-        return ns_pb::create(planes, format_hint, clamped_width, height, [default_deleter_uint8](auto* pb) { default_deleter_uint8(pb->get_base_sptr().get()); });
+        return ns_pb::create(planes, format_hint, clamped_width, height);
+    }
+
+    /* offscreen_render_target::read_current_buffer_nv12 */
+    pixel_buffer_sptr offscreen_render_target::read_current_buffer_nv12(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place)
+    {
+        auto format_hint = output.format;
+        auto [width, height] = get_output_size(output);
+        using ns_cvt = bnb::oep::converter::yuv_converter;
+
+        ns_cvt::yuv_data nv12_planes_data;
+        int32_t clamped_width = (width + 7) & ~7; /* alhoritm specific */
+        nv12_planes_data.size = m_yuv_nv12_converter->calc_min_yuv_data_size(width, height);
+
+        nv12_planes_data.data = map_readback(buffer, output, nv12_planes_data.size, in_place);
+        if (nv12_planes_data.data == nullptr) {
+            return nullptr;
+        }
+        m_yuv_nv12_converter->fill_yuv_data_planes(nv12_planes_data.data.get(), width, height, nv12_planes_data);
+
+        /* the UV plane shares the ownership of the Y plane memory */
+        using ns_pb = bnb::oep::interfaces::pixel_buffer;
+        ns_pb::plane_sptr y_plane_data(nv12_planes_data.data, nv12_planes_data.y_plane_data);
+        ns_pb::plane_sptr uv_plane_data(nv12_planes_data.data, nv12_planes_data.u_plane_data);
+        size_t y_plane_size(static_cast<size_t>(nv12_planes_data.u_plane_data - nv12_planes_data.y_plane_data));
+        size_t uv_plane_size(nv12_planes_data.size - y_plane_size);
+        ns_pb::plane_data y_plane{y_plane_data, y_plane_size, nv12_planes_data.y_plane_stride};
+        ns_pb::plane_data uv_plane{uv_plane_data, uv_plane_size, nv12_planes_data.u_plane_stride};
+
+        std::vector<ns_pb::plane_data> planes{y_plane, uv_plane};
+
+        return ns_pb::create(planes, format_hint, clamped_width, height);
     }
 
 } /* namespace bnb::oep */
@@ -2,9 +2,18 @@
 
 #include <interfaces/offscreen_effect_player.hpp>
 #include <interfaces/render_context.hpp>
+#include <atomic>
 #include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
 
+#include <opengl/pixel_pack_buffer.hpp>
 #include <opengl/yuv_converter.hpp>
+#include <opengl/bpc8_converter.hpp>
+#include <opengl/resampler.hpp>
+#include <opengl/gpu_timer.hpp>
+#include <memory/buffer_pool.hpp>
 
 namespace bnb::oep
 {
@@ -26,41 +35,134 @@ namespace bnb::oep
 
         void deactivate_context() override;
 
+        int32_t set_buffer_count(int32_t count) override;
+
+        void set_current_buffer_index(int32_t index) override;
+
         void prepare_rendering() override;
 
         void orient_image(bnb::oep::interfaces::rotation orient) override;
 
+        void prefetch(const std::vector<bnb::oep::interfaces::output_spec>& outputs) override;
+
         pixel_buffer_sptr read_current_buffer(bnb::oep::interfaces::image_format format) override;
 
+        pixel_buffer_sptr read_current_buffer(const bnb::oep::interfaces::output_spec& output) override;
+
+        bool read_current_buffer(pixel_buffer_sptr destination) override;
+
         rendered_texture_t get_current_buffer_texture() override;
 
+        void set_gpu_timers_enabled(bool enabled) override;
+
+        void collect_gpu_timings(const oep_gpu_timing_cb& callback) override;
+
+        std::shared_ptr<uint8_t> allocate_buffer(size_t size) override;
+
+        void set_buffer_pool_limits(size_t max_cached_bytes, size_t max_buffers_per_size) override;
+
+        void trim_buffer_pool() override;
+
     private:
+        struct pending_readback
+        {
+            bnb::oep::interfaces::output_spec output;
+            int32_t index{-1}; /* index in the readback ring */
+        }; /* struct pending_readback */
+
+        struct cached_image
+        {
+            bnb::oep::interfaces::output_spec output;
+            pixel_buffer_sptr image;
+        }; /* struct cached_image */
+
+        struct render_buffer
+        {
+            GLuint render_texture{0};
+            GLuint post_processing_texture{0};
+            GLuint active_texture{0};
+            bool swap_sizes{false};
+            /* orientation requested by orient_image() */
+            bnb::oep::interfaces::rotation orientation{bnb::oep::interfaces::rotation::deg0};
+            /* orientation requested by orient_image() but not rendered into the post processing texture yet */
+            std::optional<bnb::oep::interfaces::rotation> deferred_orientation;
+            /* readbacks issued and not mapped yet, at most one per output */
+            std::vector<pending_readback> readbacks;
+            /* images read since the frame was rendered, returned again without the conversion */
+            std::vector<cached_image> images;
+        }; /* struct render_buffer */
+
+        /* shared with the deleters of the pixel data, so may be changed from any thread */
+        struct readback_slot_state
+        {
+            std::atomic_bool in_use{true};
+            /* set by deinit() if the pixel data is still referenced, keeps the buffer mapped until the data is released.
+            Accessed with std::atomic_load() and std::atomic_exchange() */
+            std::shared_ptr<void> keep_alive;
+        }; /* struct readback_slot_state */
+
+        struct readback_slot
+        {
+            std::unique_ptr<pixel_pack_buffer> buffer;
+            std::shared_ptr<readback_slot_state> state;
+        }; /* struct readback_slot */
+
         void generate_texture(GLuint& texture, int32_t width, int32_t height);
         void delete_textures();
-        void delete_postprocessing_texture();
-        void prepare_post_processing_rendering();
-        pixel_buffer_sptr read_current_buffer_bpc8(bnb::oep::interfaces::image_format format_hint);
-        pixel_buffer_sptr read_current_buffer_i420(bnb::oep::interfaces::image_format format_hint);
+        void delete_textures(render_buffer& buffer);
+        void delete_postprocessing_texture(render_buffer& buffer);
+        void prepare_post_processing_rendering(render_buffer& buffer);
+        void apply_deferred_orientation(render_buffer& buffer);
+        void bind_readback_framebuffer(GLuint texture);
+        bool has_readback(const render_buffer& buffer, const bnb::oep::interfaces::output_spec& output) const;
+        pixel_buffer_sptr find_image(const render_buffer& buffer, const bnb::oep::interfaces::output_spec& output) const;
+        pixel_buffer_sptr derive_image(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output);
+        bool issue_readback(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output);
+        void submit_readbacks(render_buffer& buffer);
+        int32_t acquire_readback_slot();
+        void release_readbacks(render_buffer& buffer);
+        std::shared_ptr<void> retain_held_readbacks();
+        std::shared_ptr<uint8_t> map_readback(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, size_t size, bool in_place);
+        pixel_buffer_sptr read_current_buffer(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place);
+        bnb::oep::converter::bpc8_converter& get_bpc8_converter(bnb::oep::interfaces::image_format format);
+        bnb::oep::converter::yuv_converter& get_yuv_converter(bnb::oep::interfaces::image_format format);
+        bnb::oep::converter::resampler& get_resampler(bnb::oep::interfaces::resample_filter filter);
+        bnb::oep::interfaces::output_spec normalize_output(const bnb::oep::interfaces::output_spec& output) const;
+        std::pair<int32_t, int32_t> get_output_size(const bnb::oep::interfaces::output_spec& output) const;
+        pixel_buffer_sptr read_current_buffer_bpc8(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place);
+        pixel_buffer_sptr read_current_buffer_i420(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place);
+        pixel_buffer_sptr read_current_buffer_nv12(render_buffer& buffer, const bnb::oep::interfaces::output_spec& output, bool in_place);
+        void attach_gpu_timer(bnb::oep::converter::yuv_converter& converter);
+        void attach_gpu_timer(bnb::oep::converter::bpc8_converter& converter);
+        void attach_gpu_timer(bnb::oep::converter::resampler& resampler);
 
     private:
         render_context_sptr m_rc;
-        bool m_swap_sizes{false};
         int32_t m_width{0};
         int32_t m_height{0};
 
         GLuint m_framebuffer{0};
         GLuint m_post_processing_framebuffer{0};
-        GLuint m_last_framebuffer{0};
-        GLuint m_offscreen_render_texture{0};
-        GLuint m_offscreen_post_processuing_render_texture{0};
+        GLuint m_readback_framebuffer{0};
 
-        GLuint m_active_texture{0};
+        std::vector<render_buffer> m_buffers = std::vector<render_buffer>(1);
+        size_t m_current_buffer{0};
+        std::optional<bnb::oep::interfaces::image_format> m_readback_format_hint;
+        std::vector<readback_slot> m_readback_ring;
+        size_t m_next_readback_slot{0};
+        /* memory of the pixel data copied from the readback buffers which can not be mapped persistently */
+        std::shared_ptr<bnb::oep::memory::buffer_pool> m_buffer_pool = std::make_shared<bnb::oep::memory::buffer_pool>();
 
         std::unique_ptr<program> m_shader;
         std::once_flag m_init_flag;
         std::once_flag m_deinit_flag;
 
         std::unique_ptr<bnb::oep::converter::yuv_converter> m_yuv_i420_converter;
+        std::unique_ptr<bnb::oep::converter::yuv_converter> m_yuv_nv12_converter;
+        std::unique_ptr<bnb::oep::converter::bpc8_converter> m_bpc8_converter;
+        std::unique_ptr<bnb::oep::converter::resampler> m_resampler;
+        /* nullptr while the GPU timers are disabled */
+        std::unique_ptr<gpu_timer> m_gpu_timer;
 
         GLuint m_vbo{0};
         GLuint m_vao{0};
@@ -0,0 +1,285 @@
+#include "bpc8_converter.hpp"
+#include <profiling/trace.hpp>
+#include <stdexcept>
+
+namespace bnb::oep::converter
+{
+
+    const int bpc8_plane_vert_count = 4;
+
+    const char* bpc8_shader_vec_prog =
+        "layout(location = 0) in vec3 in_vertex;\n"
+        "void main() {\n"
+        "    gl_Position = vec4(in_vertex, 1.0);\n"
+        "}\n";
+
+    /* each texel of the framebuffer holds four bytes of the row, the bytes of the 3-byte layouts may
+    belong to two neighboring pixels. Pixels are fetched without filtering, the padding bytes at the end
+    of the row repeat the last pixel */
+    const char* bpc8_shader_frag_prog =
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "layout (location = 0) out vec4 out_color;\n"
+        "uniform sampler2D in_texture;\n"
+        "uniform int pixel_size;\n"
+        "uniform int image_width;\n"
+        "uniform ivec4 channel_order;\n"
+        "uniform ivec2 origin;\n"
+        "uniform ivec2 pixel_step;\n"
+        "uniform ivec2 row_step;\n"
+        "vec4 fetch_pixel(int x, int y) {\n"
+        "    return texelFetch(in_texture, origin + min(x, image_width - 1) * pixel_step + y * row_step, 0);\n"
+        "}\n"
+        "void main() {\n"
+        "    ivec2 coord = ivec2(gl_FragCoord.xy);\n"
+        "    int first_byte = coord.x * 4;\n"
+        "    int x = first_byte / pixel_size;\n"
+        "    int offset = first_byte - x * pixel_size;\n"
+        "    vec4 current = fetch_pixel(x, coord.y);\n"
+        "    vec4 next = current;\n"
+        "    if (offset + 3 >= pixel_size) {\n"
+        "        next = fetch_pixel(x + 1, coord.y);\n"
+        "    }\n"
+        "    vec4 color;\n"
+        "    for (int i = 0; i < 4; ++i) {\n"
+        "        int byte_index = offset + i;\n"
+        "        color[i] = byte_index < pixel_size ? current[channel_order[byte_index]] : next[channel_order[byte_index - pixel_size]];\n"
+        "    }\n"
+        "    out_color = color;\n"
+        "}\n";
+
+    /* bpc8_converter::bpc8_converter */
+    bpc8_converter::bpc8_converter(pixel_layout layout, rotation rot, bool vertical_flip)
+        : m_shader(nullptr, bpc8_shader_vec_prog, bpc8_shader_frag_prog)
+    {
+        // clang-format off
+        static const float drawing_plane_coords[3 * bpc8_plane_vert_count] = {
+            1.0f,  1.0f, 0.0f,  /* top right */
+            1.0f, -1.0f, 0.0f,  /* bottom right */
+            -1.0f,  1.0f, 0.0f, /* top left */
+            -1.0f, -1.0f, 0.0f, /* bottom left */
+        };
+        // clang-format on
+
+        set_pixel_layout(layout);
+        set_drawing_orientation(rot, vertical_flip);
+
+        /* create and bind drawing geometry */
+        glGenVertexArrays(1, &m_vao);
+        glBindVertexArray(m_vao);
+        glGenBuffers(1, &m_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(drawing_plane_coords), drawing_plane_coords, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    /* bpc8_converter::~bpc8_converter */
+    bpc8_converter::~bpc8_converter()
+    {
+        delete_framebuffer(m_fbo);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteVertexArrays(1, &m_vao);
+    }
+
+    /* bpc8_converter::set_pixel_layout */
+    void bpc8_converter::set_pixel_layout(pixel_layout layout)
+    {
+        m_pixel_layout = layout;
+    }
+
+    /* bpc8_converter::set_drawing_orientation */
+    void bpc8_converter::set_drawing_orientation(rotation rot, bool vertical_flip)
+    {
+        m_rotation = rot;
+        m_vertical_flip = vertical_flip;
+    }
+
+    /* bpc8_converter::convert */
+    void bpc8_converter::convert(uint32_t gl_texture, int width, int height, pixel_pack_buffer& output)
+    {
+        BNB_OEP_TRACE_SCOPE("bpc8_converter", "pack_pixels");
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        /* create/recreate the framebuffer if necessary, each texel holds four bytes of the row */
+        int32_t bytes_per_row = calc_bytes_per_row(width);
+        if (m_fbo.width != bytes_per_row / 4 || m_fbo.height != height) {
+            delete_framebuffer(m_fbo);
+            m_fbo = create_framebuffer(bytes_per_row / 4, height);
+        }
+        update_texel_steps(width, height);
+
+        /* indices of the texture channels in the order of the bytes of the pixel */
+        int32_t pixel_size = get_pixel_size();
+        int32_t channel_order[4]{0, 1, 2, 3};
+        switch (m_pixel_layout) {
+            case pixel_layout::rgb:
+            case pixel_layout::rgba:
+                break;
+            case pixel_layout::bgr:
+            case pixel_layout::bgra:
+                channel_order[0] = 2;
+                channel_order[2] = 0;
+                break;
+            case pixel_layout::argb:
+                channel_order[0] = 3;
+                channel_order[1] = 0;
+                channel_order[2] = 1;
+                channel_order[3] = 2;
+                break;
+        }
+
+        /* just in case, disable dropping geometry */
+        glDisable(GL_CULL_FACE);
+        /* In cases where blending was not turned off at the end of the effect */
+        glDisable(GL_BLEND);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo.fbo);
+        glViewport(0, 0, m_fbo.width, m_fbo.height);
+        glBindVertexArray(m_vao);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gl_texture);
+
+        m_shader.use();
+        m_shader.set_uniform("in_texture", 0);
+        m_shader.set_uniform("pixel_size", pixel_size);
+        m_shader.set_uniform("image_width", width);
+        m_shader.set_uniform("channel_order", channel_order[0], channel_order[1], channel_order[2], channel_order[3]);
+        m_shader.set_uniform("origin", m_origin[0], m_origin[1]);
+        m_shader.set_uniform("pixel_step", m_pixel_step[0], m_pixel_step[1]);
+        m_shader.set_uniform("row_step", m_row_step[0], m_row_step[1]);
+
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->begin(m_gpu_timer_tag);
+        }
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, bpc8_plane_vert_count);
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->end();
+        }
+
+        /* only issue the reading, the data will be available after output.map() */
+        output.read_pixels(m_fbo.width, m_fbo.height, GL_RGBA, calc_min_data_size(width, height));
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_shader.unuse();
+    }
+
+    /* bpc8_converter::set_gpu_timer */
+    void bpc8_converter::set_gpu_timer(gpu_timer* timer, int32_t tag)
+    {
+        m_gpu_timer = timer;
+        m_gpu_timer_tag = tag;
+    }
+
+    /* bpc8_converter::get_pixel_size */
+    int32_t bpc8_converter::get_pixel_size() const
+    {
+        switch (m_pixel_layout) {
+            case pixel_layout::rgb:
+            case pixel_layout::bgr:
+                return 3;
+            case pixel_layout::rgba:
+            case pixel_layout::bgra:
+            case pixel_layout::argb:
+                return 4;
+        }
+        return 4;
+    }
+
+    /* bpc8_converter::calc_bytes_per_row */
+    int32_t bpc8_converter::calc_bytes_per_row(int width) const
+    {
+        return (width * get_pixel_size() + 3) & ~3;
+    }
+
+    /* bpc8_converter::calc_min_data_size */
+    size_t bpc8_converter::calc_min_data_size(int width, int height) const
+    {
+        return static_cast<size_t>(calc_bytes_per_row(width)) * height;
+    }
+
+    /* bpc8_converter::update_texel_steps */
+    void bpc8_converter::update_texel_steps(int width, int height)
+    {
+        /* rows of the framebuffer and of the texture go from the bottom, so the orientation pass of the
+        offscreen_render_target flips the image vertically in addition to the rotation */
+        int32_t w = width - 1;
+        int32_t h = height - 1;
+        auto set_steps = [this](int32_t origin_x, int32_t origin_y, int32_t pixel_x, int32_t pixel_y, int32_t row_x, int32_t row_y) {
+            m_origin[0] = origin_x;
+            m_origin[1] = origin_y;
+            m_pixel_step[0] = pixel_x;
+            m_pixel_step[1] = pixel_y;
+            m_row_step[0] = row_x;
+            m_row_step[1] = row_y;
+        };
+        switch (m_rotation) {
+            case rotation::deg_0:
+                set_steps(0, h, 1, 0, 0, -1);
+                break;
+            case rotation::deg_90:
+                set_steps(h, w, 0, -1, -1, 0);
+                break;
+            case rotation::deg_180:
+                set_steps(w, 0, -1, 0, 0, 1);
+                break;
+            case rotation::deg_270:
+                set_steps(0, 0, 0, 1, 1, 0);
+                break;
+        }
+        if (m_vertical_flip) {
+            m_origin[0] += h * m_row_step[0];
+            m_origin[1] += h * m_row_step[1];
+            m_row_step[0] = -m_row_step[0];
+            m_row_step[1] = -m_row_step[1];
+        }
+    }
+
+    /* bpc8_converter::create_framebuffer */
+    bpc8_converter::framebuffer bpc8_converter::create_framebuffer(int width, int height)
+    {
+        uint32_t fbo;
+        uint32_t tex;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        uint32_t attach[]{GL_COLOR_ATTACHMENT0};
+        glDrawBuffers(1, attach);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteTextures(1, &tex);
+            glDeleteFramebuffers(1, &fbo);
+            throw std::runtime_error("[ERROR] Failed to make complete bpc8 framebuffer object");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return {fbo, tex, width, height};
+    }
+
+    /* bpc8_converter::delete_framebuffer */
+    void bpc8_converter::delete_framebuffer(bpc8_converter::framebuffer& fbo)
+    {
+        if (fbo.texture) {
+            glDeleteTextures(1, &fbo.texture);
+        }
+        if (fbo.fbo) {
+            glDeleteFramebuffers(1, &fbo.fbo);
+        }
+        fbo = {0, 0, 0, 0};
+    }
+
+} /* namespace bnb::oep::converter */
@@ -0,0 +1,87 @@
+/* Packs the pixels of the texture into one of the bpc8 layouts on the GPU.
+ *
+ * The pixels are rendered tightly packed into the RGBA8 framebuffer, each texel of which holds
+ * the next four bytes of the image. The rows are aligned to four bytes, so the framebuffer is
+ * read with glReadPixels(GL_RGBA) at full speed even for the 3-byte layouts and on GLES,
+ * where GL_BGR and GL_BGRA are not available.
+ */
+
+#pragma once
+#include <memory>
+#include <opengl/program.hpp>
+#include <opengl/pixel_pack_buffer.hpp>
+#include <opengl/gpu_timer.hpp>
+
+namespace bnb::oep::converter
+{
+
+    class bpc8_converter
+    {
+    public:
+        enum class pixel_layout
+        {
+            rgb,
+            bgr,
+            rgba,
+            bgra,
+            argb
+        };
+
+        enum class rotation
+        {
+            /* do not modify these assignments */
+            deg_0 = 0,
+            deg_90 = 1,
+            deg_180 = 2,
+            deg_270 = 3
+        };
+
+    public:
+        bpc8_converter(pixel_layout layout = pixel_layout::rgba, rotation rot = rotation::deg_0, bool vertical_flip = false);
+        ~bpc8_converter();
+
+        void set_pixel_layout(pixel_layout layout);
+        /* the same geometry as of the yuv_converter: rotation without the vertical flip is the same as of the
+        orientation pass of the offscreen_render_target, deg_0 with the vertical flip reads the texture as is */
+        void set_drawing_orientation(rotation rot, bool vertical_flip);
+        /* asynchronous conversion, the data will be available after output.map(). The width and the height
+        are the sizes of the image after the rotation */
+        void convert(uint32_t gl_texture, int width, int height, pixel_pack_buffer& output);
+        /* measure the pass with the timer, the tag is passed to the timer as is. nullptr disables measuring */
+        void set_gpu_timer(gpu_timer* timer, int32_t tag);
+        int32_t get_pixel_size() const;
+        /* rows are aligned to four bytes */
+        int32_t calc_bytes_per_row(int width) const;
+        size_t calc_min_data_size(int width, int height) const;
+
+    private:
+        struct framebuffer
+        {
+            uint32_t fbo{0};
+            uint32_t texture{0};
+            int width{0};
+            int height{0};
+        };
+
+    private:
+        void update_texel_steps(int width, int height);
+        framebuffer create_framebuffer(int width, int height);
+        void delete_framebuffer(framebuffer& fbo);
+
+    private:
+        uint32_t m_vbo{0};
+        uint32_t m_vao{0};
+        pixel_layout m_pixel_layout{pixel_layout::rgba};
+        rotation m_rotation{rotation::deg_0};
+        bool m_vertical_flip{false};
+        /* position in the texture of the first pixel of the image and the steps to the next pixel and row */
+        int32_t m_origin[2]{0, 0};
+        int32_t m_pixel_step[2]{0, 0};
+        int32_t m_row_step[2]{0, 0};
+        framebuffer m_fbo;
+        program m_shader;
+        gpu_timer* m_gpu_timer{nullptr};
+        int32_t m_gpu_timer_tag{0};
+    };
+
+} /* namespace bnb::oep::converter */
@@ -0,0 +1,126 @@
+#include "gpu_timer.hpp"
+
+namespace bnb::oep
+{
+
+    /* gpu_timer::gpu_timer */
+    gpu_timer::gpu_timer()
+        : m_enabled(is_supported())
+    {
+    }
+
+    /* gpu_timer::~gpu_timer */
+    gpu_timer::~gpu_timer()
+    {
+        discard();
+#if defined(GL_TIME_ELAPSED)
+        if (!m_free_queries.empty()) {
+            GL_CALL(glDeleteQueries(static_cast<GLsizei>(m_free_queries.size()), m_free_queries.data()));
+        }
+#endif /* defined(GL_TIME_ELAPSED) */
+    }
+
+    /* gpu_timer::begin */
+    void gpu_timer::begin(int32_t tag)
+    {
+#if defined(GL_TIME_ELAPSED)
+        if (!m_enabled || m_active) {
+            return;
+        }
+        if (m_pending_queries.size() >= max_pending_queries) {
+            /* nobody collects the results, the oldest measurement is lost */
+            m_free_queries.push_back(m_pending_queries.front().id);
+            m_pending_queries.pop_front();
+        }
+        auto id = acquire_query();
+        GL_CALL(glBeginQuery(GL_TIME_ELAPSED, id));
+        m_pending_queries.push_back({id, tag});
+        m_active = true;
+#endif /* defined(GL_TIME_ELAPSED) */
+    }
+
+    /* gpu_timer::end */
+    void gpu_timer::end()
+    {
+#if defined(GL_TIME_ELAPSED)
+        if (!m_active) {
+            return;
+        }
+        GL_CALL(glEndQuery(GL_TIME_ELAPSED));
+        m_active = false;
+#endif /* defined(GL_TIME_ELAPSED) */
+    }
+
+    /* gpu_timer::collect */
+    void gpu_timer::collect(const result_cb& callback)
+    {
+#if defined(GL_TIME_ELAPSED)
+        /* the queries finish in order, so the check stops at the first one without the result */
+        while (!m_pending_queries.empty()) {
+            auto& q = m_pending_queries.front();
+            if (m_active && m_pending_queries.size() == 1) {
+                /* the last query is still recording */
+                break;
+            }
+            GLuint available{0};
+            GL_CALL(glGetQueryObjectuiv(q.id, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (available == GL_FALSE) {
+                break;
+            }
+            GLuint64 elapsed{0};
+            GL_CALL(glGetQueryObjectui64v(q.id, GL_QUERY_RESULT, &elapsed));
+            auto finished = q;
+            m_pending_queries.pop_front();
+            m_free_queries.push_back(finished.id);
+            if (callback) {
+                callback(finished.tag, static_cast<int64_t>(elapsed));
+            }
+        }
+#endif /* defined(GL_TIME_ELAPSED) */
+    }
+
+    /* gpu_timer::discard */
+    void gpu_timer::discard()
+    {
+        end();
+        while (!m_pending_queries.empty()) {
+            m_free_queries.push_back(m_pending_queries.front().id);
+            m_pending_queries.pop_front();
+        }
+    }
+
+    /* gpu_timer::is_enabled */
+    bool gpu_timer::is_enabled() const
+    {
+        return m_enabled;
+    }
+
+    /* gpu_timer::is_supported */
+    bool gpu_timer::is_supported()
+    {
+#if defined(GL_TIME_ELAPSED)
+        /* core since OpenGL 3.3 */
+        GLint major{0};
+        GLint minor{0};
+        GL_CALL(glGetIntegerv(GL_MAJOR_VERSION, &major));
+        GL_CALL(glGetIntegerv(GL_MINOR_VERSION, &minor));
+        return major > 3 || (major == 3 && minor >= 3);
+#else
+        return false;
+#endif /* defined(GL_TIME_ELAPSED) */
+    }
+
+    /* gpu_timer::acquire_query */
+    GLuint gpu_timer::acquire_query()
+    {
+        GLuint id{0};
+        if (!m_free_queries.empty()) {
+            id = m_free_queries.back();
+            m_free_queries.pop_back();
+        } else {
+            GL_CALL(glGenQueries(1, &id));
+        }
+        return id;
+    }
+
+} /* namespace bnb::oep */
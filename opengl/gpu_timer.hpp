@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "opengl.hpp"
+
+namespace bnb::oep
+{
+
+    /* GPU timer of the rendering passes based on GL_TIME_ELAPSED queries.
+     * Each measured pass is marked with a tag. The results of the queries become available a few frames later,
+     * collect() passes only the finished ones and never waits for the GPU. The passes must not be nested.
+     * If the timer queries are not supported by the context all the calls do nothing */
+    class gpu_timer
+    {
+    public:
+        using result_cb = std::function<void(int32_t tag, int64_t duration_ns)>;
+
+        /* maximum number of the measurements waiting for the results, the oldest ones are discarded */
+        static constexpr size_t max_pending_queries = 64;
+
+    public:
+        gpu_timer();
+        ~gpu_timer();
+
+        gpu_timer(const gpu_timer&) = delete;
+        gpu_timer& operator=(const gpu_timer&) = delete;
+
+        void begin(int32_t tag);
+        void end();
+        void collect(const result_cb& callback);
+        void discard();
+        bool is_enabled() const;
+
+        static bool is_supported();
+
+    private:
+        struct query
+        {
+            GLuint id{0};
+            int32_t tag{0};
+        }; /* struct query */
+
+        GLuint acquire_query();
+
+    private:
+        bool m_enabled{false};
+        bool m_active{false};
+        std::vector<GLuint> m_free_queries;
+        std::deque<query> m_pending_queries;
+    }; /* class gpu_timer */
+
+} /* namespace bnb::oep */
@@ -0,0 +1,212 @@
+#include "pixel_pack_buffer.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace bnb::oep
+{
+
+    /* time to wait for the fence in one glClientWaitSync call, in nanoseconds */
+    constexpr GLuint64 fence_wait_timeout = 100000000;
+
+    /* pixel_pack_buffer::pixel_pack_buffer */
+    pixel_pack_buffer::pixel_pack_buffer(bool persistent)
+        : m_persistent(persistent && is_persistent_mapping_supported())
+    {
+        GL_CALL(glGenBuffers(1, &m_pbo));
+    }
+
+    /* pixel_pack_buffer::~pixel_pack_buffer */
+    pixel_pack_buffer::~pixel_pack_buffer()
+    {
+        discard();
+        if (m_persistent_data != nullptr) {
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+            GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            m_persistent_data = nullptr;
+        }
+        if (m_pbo != 0) {
+            GL_CALL(glDeleteBuffers(1, &m_pbo));
+            m_pbo = 0;
+        }
+    }
+
+    /* pixel_pack_buffer::read_pixels */
+    void pixel_pack_buffer::read_pixels(int32_t width, int32_t height, GLenum format, size_t size)
+    {
+        /* reads from the currently bound read framebuffer */
+        discard();
+
+        if (m_persistent && m_capacity < size) {
+            allocate_persistent_storage(size);
+        }
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+        if (m_capacity < size) {
+            GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ));
+            m_capacity = size;
+        }
+        /* with the bound pixel pack buffer the last argument is the offset in the buffer */
+        GL_CALL(glReadPixels(0, 0, width, height, format, GL_UNSIGNED_BYTE, nullptr));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        m_pending = true;
+        m_size = size;
+    }
+
+    /* pixel_pack_buffer::set_fence */
+    void pixel_pack_buffer::set_fence(const fence_sptr& fence)
+    {
+        if (m_pending && m_fence == nullptr) {
+            m_fence = fence;
+        }
+    }
+
+    /* pixel_pack_buffer::is_fenced */
+    bool pixel_pack_buffer::is_fenced() const
+    {
+        return m_fence != nullptr;
+    }
+
+    /* pixel_pack_buffer::is_pending */
+    bool pixel_pack_buffer::is_pending() const
+    {
+        return m_pending;
+    }
+
+    /* pixel_pack_buffer::is_ready */
+    bool pixel_pack_buffer::is_ready()
+    {
+        if (m_fence == nullptr) {
+            return false;
+        }
+        /* the commands must be submitted by the caller, otherwise the fence may never be signaled */
+        GLenum status = glClientWaitSync(m_fence.get(), 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    /* pixel_pack_buffer::map */
+    const uint8_t* pixel_pack_buffer::map()
+    {
+        if (!m_pending) {
+            return nullptr;
+        }
+        if (m_fence == nullptr) {
+            m_fence = insert_fence();
+        }
+
+        GLenum status{GL_TIMEOUT_EXPIRED};
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(m_fence.get(), GL_SYNC_FLUSH_COMMANDS_BIT, fence_wait_timeout);
+        }
+        m_fence.reset();
+        m_pending = false;
+        if (status == GL_WAIT_FAILED) {
+            throw std::runtime_error("[ERROR] Failed to wait for the pixel pack buffer fence.");
+        }
+
+        if (m_persistent_data != nullptr) {
+            /* coherent mapping, the data written by the GPU is visible as soon as the fence is signaled */
+            return m_persistent_data;
+        }
+
+        void* data{nullptr};
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+        GL_CALL(data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(m_size), GL_MAP_READ_BIT));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        m_mapped = data != nullptr;
+        return static_cast<const uint8_t*>(data);
+    }
+
+    /* pixel_pack_buffer::unmap */
+    void pixel_pack_buffer::unmap()
+    {
+        if (!m_mapped) {
+            return;
+        }
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+        GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        m_mapped = false;
+    }
+
+    /* pixel_pack_buffer::discard */
+    void pixel_pack_buffer::discard()
+    {
+        unmap();
+        m_fence.reset();
+        m_pending = false;
+    }
+
+    /* pixel_pack_buffer::get_size */
+    size_t pixel_pack_buffer::get_size() const
+    {
+        return m_size;
+    }
+
+    /* pixel_pack_buffer::is_persistent */
+    bool pixel_pack_buffer::is_persistent() const
+    {
+        return m_persistent;
+    }
+
+    /* pixel_pack_buffer::is_persistent_mapping_supported */
+    bool pixel_pack_buffer::is_persistent_mapping_supported()
+    {
+#if defined(GL_MAP_PERSISTENT_BIT)
+        GLint major{0};
+        GLint minor{0};
+        GL_CALL(glGetIntegerv(GL_MAJOR_VERSION, &major));
+        GL_CALL(glGetIntegerv(GL_MINOR_VERSION, &minor));
+        if (major > 4 || (major == 4 && minor >= 4)) {
+            return true;
+        }
+        GLint extensions_count{0};
+        GL_CALL(glGetIntegerv(GL_NUM_EXTENSIONS, &extensions_count));
+        for (GLint i = 0; i < extensions_count; ++i) {
+            auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension != nullptr && std::strcmp(extension, "GL_ARB_buffer_storage") == 0) {
+                return true;
+            }
+        }
+#endif /* defined(GL_MAP_PERSISTENT_BIT) */
+        return false;
+    }
+
+    /* pixel_pack_buffer::insert_fence */
+    pixel_pack_buffer::fence_sptr pixel_pack_buffer::insert_fence()
+    {
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        if (fence == nullptr) {
+            throw std::runtime_error("[ERROR] Failed to insert the fence.");
+        }
+        return fence_sptr(fence, [](GLsync sync) { glDeleteSync(sync); });
+    }
+
+    /* pixel_pack_buffer::allocate_persistent_storage */
+    void pixel_pack_buffer::allocate_persistent_storage(size_t size)
+    {
+#if defined(GL_MAP_PERSISTENT_BIT)
+        /* the storage is immutable, so the buffer is recreated to grow */
+        if (m_persistent_data != nullptr) {
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+            GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            m_persistent_data = nullptr;
+        }
+        GL_CALL(glDeleteBuffers(1, &m_pbo));
+        GL_CALL(glGenBuffers(1, &m_pbo));
+
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        void* data{nullptr};
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo));
+        GL_CALL(glBufferStorage(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags));
+        GL_CALL(data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), flags));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        if (data == nullptr) {
+            throw std::runtime_error("[ERROR] Failed to map the persistent pixel pack buffer.");
+        }
+        m_persistent_data = static_cast<uint8_t*>(data);
+        m_capacity = size;
+#endif /* defined(GL_MAP_PERSISTENT_BIT) */
+    }
+
+} /* namespace bnb::oep */
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "opengl.hpp"
+
+namespace bnb::oep
+{
+
+    /* Pixel pack buffer for the asynchronous reading of the framebuffer.
+     * read_pixels() only issues the copy of the pixels to the buffer memory, so the render thread is not blocked
+     * until the GPU finishes the rendering. The readbacks issued together share one fence set by set_fence()
+     * and submitted by the caller with a single glFlush(). The data is available via map() which waits
+     * for the fence only if it has not been signaled yet, and inserts the fence itself if none was set.
+     * The persistent buffer (GL_ARB_buffer_storage) is mapped once for its whole lifetime, so map() and unmap()
+     * do not call the driver and the returned memory stays valid until the next read_pixels() or destruction. */
+    class pixel_pack_buffer
+    {
+    public:
+        using fence_sptr = std::shared_ptr<std::remove_pointer_t<GLsync>>;
+
+    public:
+        explicit pixel_pack_buffer(bool persistent = false);
+        ~pixel_pack_buffer();
+
+        pixel_pack_buffer(const pixel_pack_buffer&) = delete;
+        pixel_pack_buffer& operator=(const pixel_pack_buffer&) = delete;
+
+        void read_pixels(int32_t width, int32_t height, GLenum format, size_t size);
+        /* the fence inserted after the read_pixels() call, does nothing if the buffer is already fenced */
+        void set_fence(const fence_sptr& fence);
+        bool is_fenced() const;
+        bool is_pending() const;
+        bool is_ready();
+        const uint8_t* map();
+        void unmap();
+        void discard();
+        size_t get_size() const;
+        bool is_persistent() const;
+
+        static bool is_persistent_mapping_supported();
+        /* the fence of all the GPU commands issued before, shared by the buffers read by them */
+        static fence_sptr insert_fence();
+
+    private:
+        void allocate_persistent_storage(size_t size);
+
+    private:
+        GLuint m_pbo{0};
+        size_t m_capacity{0};
+        size_t m_size{0};
+        fence_sptr m_fence;
+        bool m_pending{false};
+        bool m_mapped{false};
+        bool m_persistent{false};
+        uint8_t* m_persistent_data{nullptr};
+    }; /* class pixel_pack_buffer */
+
+} /* namespace bnb::oep */
@@ -85,6 +85,11 @@ namespace bnb::oep
         GL_CALL(glUniform1i(get_uniform_location(name), value));
     }
 
+    void program::set_uniform(const char* name, float value) const
+    {
+        GL_CALL(glUniform1f(get_uniform_location(name), value));
+    }
+
     void program::set_uniform(const char* name, float v1, float v2) const
     {
         GL_CALL(glUniform2f(get_uniform_location(name), v1, v2));
@@ -95,6 +100,16 @@ namespace bnb::oep
         GL_CALL(glUniform4f(get_uniform_location(name), v1, v2, v3, v4));
     }
 
+    void program::set_uniform(const char* name, int32_t v1, int32_t v2) const
+    {
+        GL_CALL(glUniform2i(get_uniform_location(name), v1, v2));
+    }
+
+    void program::set_uniform(const char* name, int32_t v1, int32_t v2, int32_t v3, int32_t v4) const
+    {
+        GL_CALL(glUniform4i(get_uniform_location(name), v1, v2, v3, v4));
+    }
+
     uint32_t program::get_uniform_location(const char* name) const
     {
         GLint loc;
@@ -18,8 +18,11 @@ namespace bnb::oep
         void unuse() const;
 
         void set_uniform(const char* name, int32_t value) const;
+        void set_uniform(const char* name, float value) const;
         void set_uniform(const char* name, float v1, float v2) const;
         void set_uniform(const char* name, float v1, float v2, float v3, float v4) const;
+        void set_uniform(const char* name, int32_t v1, int32_t v2) const;
+        void set_uniform(const char* name, int32_t v1, int32_t v2, int32_t v3, int32_t v4) const;
 
         uint32_t get_uniform_location(const char* name) const;
         uint32_t handle() const;
@@ -0,0 +1,324 @@
+#include "resampler.hpp"
+#include <profiling/trace.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace bnb::oep::converter
+{
+
+    const int resampler_plane_vert_count = 4;
+
+    /* the number of the output sizes which textures are kept between the frames, the oldest one is deleted first */
+    constexpr size_t resampler_max_targets = 4;
+
+    const char* resampler_shader_vec_prog =
+        "layout(location = 0) in vec3 in_vertex;\n"
+        "void main() {\n"
+        "    gl_Position = vec4(in_vertex, 1.0);\n"
+        "}\n";
+
+    /* the pixel of the rotated source image (x, y) is the texel origin + x * pixel_step + y * row_step of the texture.
+    The pass resamples the pixels along the filter axis, the other coordinate of the fragment is the same as of
+    the source pixel. The nearest filter (the negative filter axis) resamples both coordinates */
+    const char* resampler_shader_frag_prog =
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "layout (location = 0) out vec4 out_color;\n"
+        "uniform sampler2D in_texture;\n"
+        "uniform ivec2 origin;\n"
+        "uniform ivec2 pixel_step;\n"
+        "uniform ivec2 row_step;\n"
+        "uniform ivec2 source_size;\n"
+        "uniform vec2 scale;\n"
+        "uniform int filter_axis;\n"
+        "uniform int filter_type;\n"
+        "uniform float kernel_step;\n"
+        "uniform int radius;\n"
+        "vec4 fetch_pixel(ivec2 pos) {\n"
+        "    pos = clamp(pos, ivec2(0), source_size - 1);\n"
+        "    return texelFetch(in_texture, origin + pos.x * pixel_step + pos.y * row_step, 0);\n"
+        "}\n"
+        "float kernel(float x) {\n"
+        "    x = abs(x);\n"
+        "    if (filter_type == 1) {\n"
+        "        return max(1.0 - x, 0.0);\n"
+        "    }\n"
+        "    if (filter_type == 2) {\n"
+        "        /* Catmull-Rom spline */\n"
+        "        if (x < 1.0) {\n"
+        "            return (1.5 * x - 2.5) * x * x + 1.0;\n"
+        "        }\n"
+        "        return x < 2.0 ? ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0 : 0.0;\n"
+        "    }\n"
+        "    /* Lanczos with three lobes */\n"
+        "    if (x < 1.0e-4) {\n"
+        "        return 1.0;\n"
+        "    }\n"
+        "    if (x >= 3.0) {\n"
+        "        return 0.0;\n"
+        "    }\n"
+        "    float px = 3.14159265 * x;\n"
+        "    return 3.0 * sin(px) * sin(px / 3.0) / (px * px);\n"
+        "}\n"
+        "void main() {\n"
+        "    ivec2 coord = ivec2(gl_FragCoord.xy);\n"
+        "    if (filter_axis < 0) {\n"
+        "        out_color = fetch_pixel(ivec2((vec2(coord) + 0.5) * scale));\n"
+        "        return;\n"
+        "    }\n"
+        "    float center = (float(coord[filter_axis]) + 0.5) * scale[filter_axis] - 0.5;\n"
+        "    int first = int(floor(center)) - radius + 1;\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    float weight_sum = 0.0;\n"
+        "    ivec2 pos = coord;\n"
+        "    for (int i = 0; i < 2 * radius; ++i) {\n"
+        "        pos[filter_axis] = first + i;\n"
+        "        float weight = kernel((float(first + i) - center) * kernel_step);\n"
+        "        sum += weight * fetch_pixel(pos);\n"
+        "        weight_sum += weight;\n"
+        "    }\n"
+        "    out_color = sum / weight_sum;\n"
+        "}\n";
+
+    /* resampler::resampler */
+    resampler::resampler(filter flt, rotation rot)
+        : m_shader(nullptr, resampler_shader_vec_prog, resampler_shader_frag_prog)
+    {
+        // clang-format off
+        static const float drawing_plane_coords[3 * resampler_plane_vert_count] = {
+            1.0f,  1.0f, 0.0f,  /* top right */
+            1.0f, -1.0f, 0.0f,  /* bottom right */
+            -1.0f,  1.0f, 0.0f, /* top left */
+            -1.0f, -1.0f, 0.0f, /* bottom left */
+        };
+        // clang-format on
+
+        set_filter(flt);
+        set_drawing_orientation(rot);
+
+        /* create and bind drawing geometry */
+        glGenVertexArrays(1, &m_vao);
+        glBindVertexArray(m_vao);
+        glGenBuffers(1, &m_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(drawing_plane_coords), drawing_plane_coords, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, nullptr);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    /* resampler::~resampler */
+    resampler::~resampler()
+    {
+        for (auto& t : m_targets) {
+            delete_framebuffer(t.intermediate);
+            delete_framebuffer(t.output);
+        }
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteVertexArrays(1, &m_vao);
+    }
+
+    /* resampler::set_filter */
+    void resampler::set_filter(filter flt)
+    {
+        m_filter = flt;
+    }
+
+    /* resampler::set_drawing_orientation */
+    void resampler::set_drawing_orientation(rotation rot)
+    {
+        m_rotation = rot;
+    }
+
+    /* resampler::resample */
+    uint32_t resampler::resample(uint32_t gl_texture, int source_width, int source_height, int width, int height)
+    {
+        BNB_OEP_TRACE_SCOPE("resampler", "resample");
+        if (source_width <= 0 || source_height <= 0 || width <= 0 || height <= 0) {
+            return 0;
+        }
+
+        bool swap_sizes = m_rotation == rotation::deg_90 || m_rotation == rotation::deg_270;
+        int rotated_width = swap_sizes ? source_height : source_width;
+        int rotated_height = swap_sizes ? source_width : source_height;
+        update_texel_steps(rotated_width, rotated_height);
+        auto& t = get_target(rotated_height, width, height);
+
+        /* just in case, disable dropping geometry */
+        glDisable(GL_CULL_FACE);
+        /* In cases where blending was not turned off at the end of the effect */
+        glDisable(GL_BLEND);
+
+        glBindVertexArray(m_vao);
+        glActiveTexture(GL_TEXTURE0);
+        m_shader.use();
+        m_shader.set_uniform("in_texture", 0);
+        m_shader.set_uniform("filter_type", static_cast<int32_t>(m_filter));
+
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->begin(m_gpu_timer_tag);
+        }
+        if (m_filter == filter::nearest) {
+            draw_pass(t.output, gl_texture, m_origin, m_pixel_step, m_row_step, rotated_width, rotated_height, -1);
+        } else {
+            /* the rows of the intermediate texture are read as is */
+            static const int32_t identity_origin[2]{0, 0};
+            static const int32_t identity_pixel_step[2]{1, 0};
+            static const int32_t identity_row_step[2]{0, 1};
+            draw_pass(t.intermediate, gl_texture, m_origin, m_pixel_step, m_row_step, rotated_width, rotated_height, 0);
+            draw_pass(t.output, t.intermediate.texture, identity_origin, identity_pixel_step, identity_row_step, width, rotated_height, 1);
+        }
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->end();
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_shader.unuse();
+        return t.output.texture;
+    }
+
+    /* resampler::set_gpu_timer */
+    void resampler::set_gpu_timer(gpu_timer* timer, int32_t tag)
+    {
+        m_gpu_timer = timer;
+        m_gpu_timer_tag = tag;
+    }
+
+    /* resampler::draw_pass */
+    void resampler::draw_pass(const framebuffer& fbo, uint32_t gl_texture, const int32_t* origin, const int32_t* pixel_step, const int32_t* row_step, int source_width, int source_height, int filter_axis)
+    {
+        /* the number of the source pixels per the output pixel */
+        float scale_x = static_cast<float>(source_width) / static_cast<float>(fbo.width);
+        float scale_y = static_cast<float>(source_height) / static_cast<float>(fbo.height);
+        /* the kernel is widened on downscaling, so it covers all the source pixels of the output pixel */
+        float scale = std::max(filter_axis == 0 ? scale_x : scale_y, 1.0f);
+        float support{1.0f};
+        switch (m_filter) {
+            case filter::nearest:
+            case filter::bilinear:
+                break;
+            case filter::bicubic:
+                support = 2.0f;
+                break;
+            case filter::lanczos:
+                support = 3.0f;
+                break;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo.fbo);
+        glViewport(0, 0, fbo.width, fbo.height);
+        glBindTexture(GL_TEXTURE_2D, gl_texture);
+        m_shader.set_uniform("origin", origin[0], origin[1]);
+        m_shader.set_uniform("pixel_step", pixel_step[0], pixel_step[1]);
+        m_shader.set_uniform("row_step", row_step[0], row_step[1]);
+        m_shader.set_uniform("source_size", source_width, source_height);
+        m_shader.set_uniform("scale", scale_x, scale_y);
+        m_shader.set_uniform("filter_axis", filter_axis);
+        m_shader.set_uniform("kernel_step", 1.0f / scale);
+        m_shader.set_uniform("radius", static_cast<int32_t>(std::ceil(support * scale)));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, resampler_plane_vert_count);
+    }
+
+    /* resampler::get_target */
+    resampler::target& resampler::get_target(int source_height, int width, int height)
+    {
+        bool needs_intermediate = m_filter != filter::nearest;
+        auto it = std::find_if(m_targets.begin(), m_targets.end(), [width, height](const target& t) {
+            return t.output.width == width && t.output.height == height;
+        });
+        if (it == m_targets.end()) {
+            if (m_targets.size() >= resampler_max_targets) {
+                delete_framebuffer(m_targets.front().intermediate);
+                delete_framebuffer(m_targets.front().output);
+                m_targets.erase(m_targets.begin());
+            }
+            m_targets.push_back({{}, create_framebuffer(width, height)});
+            it = m_targets.end() - 1;
+        }
+
+        /* the intermediate texture has the width of the output and the height of the source */
+        auto& intermediate = it->intermediate;
+        if (needs_intermediate && (intermediate.width != width || intermediate.height != source_height)) {
+            delete_framebuffer(intermediate);
+            intermediate = create_framebuffer(width, source_height);
+        }
+        return *it;
+    }
+
+    /* resampler::update_texel_steps */
+    void resampler::update_texel_steps(int width, int height)
+    {
+        /* the same steps as of the not flipped geometry of the bpc8_converter, so the rows of the output
+        are in the same order as of the texture of the orientation pass */
+        int32_t w = width - 1;
+        int32_t h = height - 1;
+        auto set_steps = [this](int32_t origin_x, int32_t origin_y, int32_t pixel_x, int32_t pixel_y, int32_t row_x, int32_t row_y) {
+            m_origin[0] = origin_x;
+            m_origin[1] = origin_y;
+            m_pixel_step[0] = pixel_x;
+            m_pixel_step[1] = pixel_y;
+            m_row_step[0] = row_x;
+            m_row_step[1] = row_y;
+        };
+        switch (m_rotation) {
+            case rotation::deg_0:
+                set_steps(0, h, 1, 0, 0, -1);
+                break;
+            case rotation::deg_90:
+                set_steps(h, w, 0, -1, -1, 0);
+                break;
+            case rotation::deg_180:
+                set_steps(w, 0, -1, 0, 0, 1);
+                break;
+            case rotation::deg_270:
+                set_steps(0, 0, 0, 1, 1, 0);
+                break;
+        }
+    }
+
+    /* resampler::create_framebuffer */
+    resampler::framebuffer resampler::create_framebuffer(int width, int height)
+    {
+        uint32_t fbo;
+        uint32_t tex;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        uint32_t attach[]{GL_COLOR_ATTACHMENT0};
+        glDrawBuffers(1, attach);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteTextures(1, &tex);
+            glDeleteFramebuffers(1, &fbo);
+            throw std::runtime_error("[ERROR] Failed to make complete resampler framebuffer object");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return {fbo, tex, width, height};
+    }
+
+    /* resampler::delete_framebuffer */
+    void resampler::delete_framebuffer(resampler::framebuffer& fbo)
+    {
+        if (fbo.texture) {
+            glDeleteTextures(1, &fbo.texture);
+        }
+        if (fbo.fbo) {
+            glDeleteFramebuffers(1, &fbo.fbo);
+        }
+        fbo = {0, 0, 0, 0};
+    }
+
+} /* namespace bnb::oep::converter */
@@ -0,0 +1,93 @@
+/* Resamples the texture to the size of the output on the GPU.
+ *
+ * The image is rotated by the same geometry as of the orientation pass of the offscreen_render_target
+ * and resampled by the separable filter: the first pass resamples the rows into the intermediate texture,
+ * the second one resamples the columns. The nearest filter is applied in one pass. The pixels are fetched
+ * without the hardware filtering, and the kernel is widened on downscaling, so all the covered pixels
+ * are averaged and the image is not aliased.
+ */
+
+#pragma once
+#include <memory>
+#include <vector>
+#include <opengl/program.hpp>
+#include <opengl/gpu_timer.hpp>
+
+namespace bnb::oep::converter
+{
+
+    class resampler
+    {
+    public:
+        enum class filter
+        {
+            /* do not modify these assignments */
+            nearest = 0,
+            bilinear = 1,
+            bicubic = 2,
+            lanczos = 3
+        };
+
+        enum class rotation
+        {
+            /* do not modify these assignments */
+            deg_0 = 0,
+            deg_90 = 1,
+            deg_180 = 2,
+            deg_270 = 3
+        };
+
+    public:
+        resampler(filter flt = filter::bilinear, rotation rot = rotation::deg_0);
+        ~resampler();
+
+        void set_filter(filter flt);
+        /* the same geometry as of the orientation pass of the offscreen_render_target */
+        void set_drawing_orientation(rotation rot);
+        /* resample the texture of the source sizes (before the rotation) to the width and the height (after the rotation).
+        Returns the texture with the rows in the same order as of the texture of the orientation pass, so it is converted
+        with the deg_0 flipped geometry of the converters. The texture is owned by the resampler and is overwritten
+        by the next call with the same sizes */
+        uint32_t resample(uint32_t gl_texture, int source_width, int source_height, int width, int height);
+        /* measure the passes with the timer, the tag is passed to the timer as is. nullptr disables measuring */
+        void set_gpu_timer(gpu_timer* timer, int32_t tag);
+
+    private:
+        struct framebuffer
+        {
+            uint32_t fbo{0};
+            uint32_t texture{0};
+            int width{0};
+            int height{0};
+        };
+
+        /* the textures of one output size, the sizes of several outputs of the frame usually differ */
+        struct target
+        {
+            framebuffer intermediate; /* the resampled rows, not created for the nearest filter */
+            framebuffer output;
+        };
+
+    private:
+        target& get_target(int source_height, int width, int height);
+        void update_texel_steps(int width, int height);
+        void draw_pass(const framebuffer& fbo, uint32_t gl_texture, const int32_t* origin, const int32_t* pixel_step, const int32_t* row_step, int source_width, int source_height, int filter_axis);
+        framebuffer create_framebuffer(int width, int height);
+        void delete_framebuffer(framebuffer& fbo);
+
+    private:
+        uint32_t m_vbo{0};
+        uint32_t m_vao{0};
+        filter m_filter{filter::bilinear};
+        rotation m_rotation{rotation::deg_0};
+        /* position in the source texture of the first pixel of the rotated image and the steps to the next pixel and row */
+        int32_t m_origin[2]{0, 0};
+        int32_t m_pixel_step[2]{0, 0};
+        int32_t m_row_step[2]{0, 0};
+        std::vector<target> m_targets;
+        program m_shader;
+        gpu_timer* m_gpu_timer{nullptr};
+        int32_t m_gpu_timer_tag{0};
+    };
+
+} /* namespace bnb::oep::converter */
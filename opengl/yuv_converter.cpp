@@ -1,4 +1,5 @@
 #include "yuv_converter.hpp"
+#include <profiling/trace.hpp>
 #include <string>
 
 static const char* to_gl_check_framebuffer_status(GLenum e)
@@ -66,6 +67,29 @@ namespace bnb::oep::converter
         "    out_color.a = a + dot(rgb, texture(in_texture, uv_coord + 1.5 * pixel_step).rgb);\n"
         "}\n";
 
+    /* two chroma samples per texel stored as U V U V, the samples are the same as of the U and V planes:
+    each pair of texels reads the four samples of one texel of the planar layout */
+    const char* shader_uv_frag_prog =
+        "precision mediump float;\n"
+        "layout (location = 0) out vec4 out_color;\n"
+        "uniform vec2 pixel_step;\n"
+        "uniform vec2 half_texel_step;\n"
+        "uniform vec4 u_plane_coef;\n"
+        "uniform vec4 v_plane_coef;\n"
+        "uniform sampler2D in_texture;\n"
+        "in vec2 uv_coord;\n"
+        "void main() {\n"
+        "    float odd = mod(floor(gl_FragCoord.x), 2.0);\n"
+        "    vec2 center = uv_coord + (1.0 - 2.0 * odd) * half_texel_step;\n"
+        "    vec2 first_coord = center + (2.0 * odd - 1.5) * pixel_step;\n"
+        "    vec3 first = texture(in_texture, first_coord).rgb;\n"
+        "    vec3 second = texture(in_texture, first_coord + pixel_step).rgb;\n"
+        "    out_color.r = u_plane_coef.a + dot(u_plane_coef.rgb, first);\n"
+        "    out_color.g = v_plane_coef.a + dot(v_plane_coef.rgb, first);\n"
+        "    out_color.b = u_plane_coef.a + dot(u_plane_coef.rgb, second);\n"
+        "    out_color.a = v_plane_coef.a + dot(v_plane_coef.rgb, second);\n"
+        "}\n";
+
 
     /* yuv_converter::yuv_converter */
     yuv_converter::yuv_converter(standard st, range rng, rotation rot, bool vertical_flip, yuv_data_layout data_layout)
@@ -120,6 +144,9 @@ namespace bnb::oep::converter
 
         set_convert_standard(st, rng);
         set_drawing_orientation(rot, vertical_flip);
+        if (m_data_layout == yuv_data_layout::semi_planar_layout) {
+            m_uv_shader = std::make_unique<program>(nullptr, shader_vec_prog, shader_uv_frag_prog);
+        }
 
         /* create and bind drawing geometry */
         glGenVertexArrays(1, &m_vao);
@@ -209,21 +236,59 @@ namespace bnb::oep::converter
     }
 
     /* yuv_converter::convert */
-    void yuv_converter::convert(uint32_t gl_texture, int width, int height, yuv_converter::yuv_data& output)
+    void yuv_converter::convert(uint32_t gl_texture, int width, int height, pixel_pack_buffer& output)
+    {
+        if (!draw(gl_texture, width, height)) {
+            return;
+        }
+
+        /* only issue the reading of all YUV planes, the data will be available after output.map() */
+        output.read_pixels(m_fbo.width, m_fbo.height, GL_RGBA, calc_min_yuv_data_size(width, height));
+        unbind();
+    }
+
+    /* yuv_converter::fill_yuv_data_planes */
+    void yuv_converter::fill_yuv_data_planes(uint8_t* data, int width, int height, yuv_converter::yuv_data& output)
+    {
+        int stride = (width + 7) & ~7;
+        int half_height = (height + 1) / 2;
+        int half_viewport_width = stride / 8;
+        output.y_plane_data = data;
+        output.u_plane_data = data + stride * height;
+        switch (m_data_layout) {
+            case yuv_data_layout::semi_planar_row_interleaved:
+                output.v_plane_data = data + stride * height + half_viewport_width * 4;
+                break;
+            case yuv_data_layout::planar_layout:
+                output.v_plane_data = data + stride * height + stride * half_height;
+                break;
+            case yuv_data_layout::semi_planar_layout:
+                output.v_plane_data = data + stride * height + 1;
+                break;
+        }
+        output.y_plane_stride = stride;
+        output.u_plane_stride = stride;
+        output.v_plane_stride = stride;
+    }
+
+    /* yuv_converter::draw */
+    bool yuv_converter::draw(uint32_t gl_texture, int width, int height)
     {
+        BNB_OEP_TRACE_SCOPE("yuv_converter", "draw_planes");
         /* create/recreate the framebuffer if necessary */
         int stride = (width + 7) & ~7;
         int half_height = (height + 1) / 2;
         int half_viewport_width = stride / 8;
         if (m_width != width || m_height != height) {
             if (width <= 0 || height <= 0) {
-                return;
+                return false;
             }
             m_width = width;
             m_height = height;
             delete_framebuffer(m_fbo);
             switch (m_data_layout) {
                 case yuv_data_layout::semi_planar_row_interleaved:
+                case yuv_data_layout::semi_planar_layout:
                     m_fbo = create_framebuffer(stride / 4, m_height + half_height);
                     break;
                 case yuv_data_layout::planar_layout:
@@ -233,12 +298,6 @@ namespace bnb::oep::converter
             update_pixel_steps();
         }
 
-        /* allocate/reallocate memory if necessary */
-        if (output.data == nullptr || output.size < calc_min_yuv_data_size(width, height)) {
-            output.size = calc_min_yuv_data_size(width, height);
-            output.data = std::shared_ptr<uint8_t>(new uint8_t[output.size], std::default_delete<uint8_t>());
-        }
-
         /* just in case, disable dropping geometry */
         glDisable(GL_CULL_FACE);
 
@@ -264,7 +323,23 @@ namespace bnb::oep::converter
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo.fbo);
         m_shader.set_uniform("plane_coef", m_y_plane_coefs[0], m_y_plane_coefs[1], m_y_plane_coefs[2], m_y_plane_coefs[3]);
         glViewport(0, 0, m_fbo.width, m_height);
-        glDrawArrays(GL_TRIANGLE_STRIP, m_draw_indent, drawing_plane_vert_count);
+        draw_plane(m_gpu_timer_tags[0]);
+
+        if (m_uv_shader != nullptr) {
+            /* render interleaved UV plane to the framebuffer, each texel contains two chroma samples */
+            m_uv_shader->use();
+            m_uv_shader->set_uniform("in_texture", 0);
+            m_uv_shader->set_uniform("pixel_step", m_pixel_step_uv[0], m_pixel_step_uv[1]);
+            /* the half of the texel of the UV plane in texture coordinates */
+            float texel_scale = 2.0f * static_cast<float>(m_width) / static_cast<float>(stride);
+            m_uv_shader->set_uniform("half_texel_step", m_pixel_step_y[0] * texel_scale, m_pixel_step_y[1] * texel_scale);
+            m_uv_shader->set_uniform("u_plane_coef", m_u_plane_coefs[0], m_u_plane_coefs[1], m_u_plane_coefs[2], m_u_plane_coefs[3]);
+            m_uv_shader->set_uniform("v_plane_coef", m_v_plane_coefs[0], m_v_plane_coefs[1], m_v_plane_coefs[2], m_v_plane_coefs[3]);
+            glViewport(0, m_height, m_fbo.width, half_height);
+            draw_plane(m_gpu_timer_tags[1]);
+            /* the framebuffer stays bound for reading */
+            return true;
+        }
 
         /* pixel step used in the shader to access neighboring pixels */
         m_shader.set_uniform("pixel_step", m_pixel_step_uv[0], m_pixel_step_uv[1]);
@@ -272,39 +347,50 @@ namespace bnb::oep::converter
         /* render U and V planes to the framebuffer */
         m_shader.set_uniform("plane_coef", m_u_plane_coefs[0], m_u_plane_coefs[1], m_u_plane_coefs[2], m_u_plane_coefs[3]);
         glViewport(0, m_height, half_viewport_width, half_height);
-        glDrawArrays(GL_TRIANGLE_STRIP, m_draw_indent, drawing_plane_vert_count);
+        draw_plane(m_gpu_timer_tags[1]);
         m_shader.set_uniform("plane_coef", m_v_plane_coefs[0], m_v_plane_coefs[1], m_v_plane_coefs[2], m_v_plane_coefs[3]);
         switch (m_data_layout) {
             case yuv_data_layout::semi_planar_row_interleaved:
                 glViewport(half_viewport_width, m_height, half_viewport_width, half_height);
                 break;
             case yuv_data_layout::planar_layout:
+            case yuv_data_layout::semi_planar_layout:
                 glViewport(0, m_height + half_height, half_viewport_width, half_height);
                 break;
         }
+        draw_plane(m_gpu_timer_tags[2]);
+        /* the framebuffer stays bound for reading */
+        return true;
+    }
+
+    /* yuv_converter::draw_plane */
+    void yuv_converter::draw_plane(int32_t timer_tag)
+    {
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->begin(timer_tag);
+        }
         glDrawArrays(GL_TRIANGLE_STRIP, m_draw_indent, drawing_plane_vert_count);
-        /* and read all YUV planes data */
-        glReadPixels(0, 0, m_fbo.width, m_fbo.height, GL_RGBA, GL_UNSIGNED_BYTE, output.data.get());
+        if (m_gpu_timer != nullptr) {
+            m_gpu_timer->end();
+        }
+    }
 
-        /* unbind all */
+    /* yuv_converter::set_gpu_timer */
+    void yuv_converter::set_gpu_timer(gpu_timer* timer, int32_t y_plane_tag, int32_t u_plane_tag, int32_t v_plane_tag)
+    {
+        m_gpu_timer = timer;
+        m_gpu_timer_tags[0] = y_plane_tag;
+        m_gpu_timer_tags[1] = u_plane_tag;
+        m_gpu_timer_tags[2] = v_plane_tag;
+    }
+
+    /* yuv_converter::unbind */
+    void yuv_converter::unbind()
+    {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glBindVertexArray(0);
         glBindTexture(GL_TEXTURE_2D, 0);
         m_shader.unuse();
-
-        output.y_plane_data = output.data.get();
-        output.u_plane_data = output.data.get() + stride * m_height;
-        switch (m_data_layout) {
-            case yuv_data_layout::semi_planar_row_interleaved:
-                output.v_plane_data = output.data.get() + stride * m_height + half_viewport_width * 4;
-                break;
-            case yuv_data_layout::planar_layout:
-                output.v_plane_data = output.data.get() + stride * m_height + stride * half_height;
-                break;
-        }
-        output.y_plane_stride = stride;
-        output.u_plane_stride = stride;
-        output.v_plane_stride = stride;
     }
 
     /* yuv_converter::calc_min_yuv_data_size */
@@ -313,6 +399,7 @@ namespace bnb::oep::converter
         auto stride = (width + 7) & ~7;
         switch (m_data_layout) {
             case yuv_data_layout::semi_planar_row_interleaved:
+            case yuv_data_layout::semi_planar_layout:
                 return stride * (height + (height + 1) / 2);
             case yuv_data_layout::planar_layout:
                 return stride * ((height + 1) & ~1) * 2;
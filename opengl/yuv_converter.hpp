@@ -10,6 +10,8 @@
 #pragma once
 #include <memory>
 #include <opengl/program.hpp>
+#include <opengl/pixel_pack_buffer.hpp>
+#include <opengl/gpu_timer.hpp>
 
 namespace bnb::oep::converter
 {
@@ -71,7 +73,22 @@ namespace bnb::oep::converter
             * | plane |       |
             * +-------+-------+
             */
-            planar_layout  /* Y, U and V planes stored sequentially */
+            planar_layout, /* Y, U and V planes stored sequentially */
+
+            /* NV12 layout
+            * to get the minimum required memory size call function 'calc_min_yuv_data_size(width, height)'
+            * representation in memory:
+            * +---------------+
+            * |               |
+            * |       Y       |
+            * |     plane     |
+            * |               |
+            * +---------------+
+            * | U V U V U V   |
+            * |   UV plane    |
+            * +---------------+
+            */
+            semi_planar_layout /* U and V samples are interleaved in one plane, the V plane data points to the second byte of it */
         };
 
         struct yuv_data
@@ -92,7 +109,11 @@ namespace bnb::oep::converter
 
         void set_convert_standard(standard st, range rng);
         void set_drawing_orientation(rotation rot, bool vertical_flip);
-        void convert(uint32_t gl_texture, int width, int height, yuv_data& output);
+        /* asynchronous conversion, the planes of the mapped buffer are defined by fill_yuv_data_planes() */
+        void convert(uint32_t gl_texture, int width, int height, pixel_pack_buffer& output);
+        void fill_yuv_data_planes(uint8_t* data, int width, int height, yuv_data& output);
+        /* measure each plane pass with the timer, the tags are passed to the timer as is. nullptr disables measuring */
+        void set_gpu_timer(gpu_timer* timer, int32_t y_plane_tag, int32_t u_plane_tag, int32_t v_plane_tag);
         int get_width();
         int get_height();
         size_t calc_min_yuv_data_size(int width, int height);
@@ -107,6 +128,9 @@ namespace bnb::oep::converter
         };
 
     private:
+        bool draw(uint32_t gl_texture, int width, int height);
+        void unbind();
+        void draw_plane(int32_t timer_tag);
         void update_pixel_steps();
         framebuffer create_framebuffer(int width, int height);
         void delete_framebuffer(framebuffer& fbo);
@@ -127,6 +151,10 @@ namespace bnb::oep::converter
         yuv_data_layout m_data_layout{yuv_data_layout::planar_layout};
         framebuffer m_fbo;
         program m_shader;
+        /* renders the interleaved UV plane of the semi_planar_layout in one pass, nullptr for other layouts */
+        std::unique_ptr<program> m_uv_shader;
+        gpu_timer* m_gpu_timer{nullptr};
+        int32_t m_gpu_timer_tags[3]{0, 0, 0};
     };
 
 
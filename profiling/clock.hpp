@@ -0,0 +1,15 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace bnb::oep::profiling
+{
+
+    /* monotonic timestamp in nanoseconds, the same clock is used for all the timings of the pipeline */
+    inline int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+} /* namespace bnb::oep::profiling */
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <interfaces/frame_timings.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace bnb::oep::profiling
+{
+
+    /* Lock free log-linear histogram of durations in nanoseconds. Every power of two range is split into
+     * sub_bucket_count buckets, so the relative error of the percentiles is below 1 / sub_bucket_count.
+     * record() may be called from any thread and never blocks or allocates */
+    class latency_histogram
+    {
+    public:
+        static constexpr int32_t sub_bucket_bits = 3;
+        static constexpr int32_t sub_bucket_count = 1 << sub_bucket_bits;
+        /* the values below linear_count have their own buckets */
+        static constexpr int32_t linear_count = sub_bucket_count * 2;
+        static constexpr int32_t linear_bits = sub_bucket_bits + 1;
+        static constexpr int32_t bucket_count = linear_count + (63 - linear_bits) * sub_bucket_count;
+
+    public:
+        latency_histogram()
+        {
+            reset();
+        }
+
+        void record(int64_t value_ns) noexcept
+        {
+            if (value_ns < 0) {
+                value_ns = 0;
+            }
+            m_buckets[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value_ns, std::memory_order_relaxed);
+
+            auto min = m_min.load(std::memory_order_relaxed);
+            while (value_ns < min && !m_min.compare_exchange_weak(min, value_ns, std::memory_order_relaxed)) {
+            }
+            auto max = m_max.load(std::memory_order_relaxed);
+            while (value_ns > max && !m_max.compare_exchange_weak(max, value_ns, std::memory_order_relaxed)) {
+            }
+        }
+
+        /* not atomic as a whole, the values recorded concurrently may be partially included */
+        interfaces::latency_histogram_snapshot snapshot() const
+        {
+            interfaces::latency_histogram_snapshot result;
+            std::array<uint64_t, bucket_count> buckets;
+            uint64_t count = 0;
+            for (int32_t i = 0; i < bucket_count; ++i) {
+                buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+                count += buckets[i];
+            }
+            if (count == 0) {
+                return result;
+            }
+
+            result.count = count;
+            result.min_ns = m_min.load(std::memory_order_relaxed);
+            result.max_ns = m_max.load(std::memory_order_relaxed);
+            result.mean_ns = m_sum.load(std::memory_order_relaxed) / static_cast<int64_t>(std::max<uint64_t>(m_count.load(std::memory_order_relaxed), 1));
+            result.p50_ns = percentile(buckets, count, 50, result.min_ns, result.max_ns);
+            result.p95_ns = percentile(buckets, count, 95, result.min_ns, result.max_ns);
+            result.p99_ns = percentile(buckets, count, 99, result.min_ns, result.max_ns);
+            return result;
+        }
+
+        void reset() noexcept
+        {
+            for (auto& bucket : m_buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            m_count.store(0, std::memory_order_relaxed);
+            m_sum.store(0, std::memory_order_relaxed);
+            m_min.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static int32_t most_significant_bit(uint64_t value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return 63 - __builtin_clzll(value);
+#else
+            int32_t msb = 0;
+            while (value >>= 1) {
+                ++msb;
+            }
+            return msb;
+#endif
+        }
+
+        static int32_t bucket_index(int64_t value)
+        {
+            if (value < linear_count) {
+                return static_cast<int32_t>(value);
+            }
+            auto msb = most_significant_bit(static_cast<uint64_t>(value));
+            auto sub_bucket = static_cast<int32_t>((value >> (msb - sub_bucket_bits)) & (sub_bucket_count - 1));
+            return linear_count + (msb - linear_bits) * sub_bucket_count + sub_bucket;
+        }
+
+        static int64_t bucket_lower_bound(int32_t index)
+        {
+            if (index < linear_count) {
+                return index;
+            }
+            auto msb = (index - linear_count) / sub_bucket_count + linear_bits;
+            auto sub_bucket = static_cast<int64_t>((index - linear_count) % sub_bucket_count);
+            return (int64_t(1) << msb) + (sub_bucket << (msb - sub_bucket_bits));
+        }
+
+        /* the middle of the bucket containing the percentile, clamped by the recorded range */
+        static int64_t percentile(const std::array<uint64_t, bucket_count>& buckets, uint64_t count, int32_t percent, int64_t min, int64_t max)
+        {
+            auto rank = (count * static_cast<uint64_t>(percent) + 99) / 100;
+            uint64_t accumulated = 0;
+            for (int32_t i = 0; i < bucket_count; ++i) {
+                accumulated += buckets[i];
+                if (accumulated >= rank && buckets[i] != 0) {
+                    auto lower = bucket_lower_bound(i);
+                    auto upper = i + 1 < bucket_count ? bucket_lower_bound(i + 1) - 1 : std::numeric_limits<int64_t>::max();
+                    auto value = lower + (upper - lower) / 2;
+                    return value < min ? min : (value > max ? max : value);
+                }
+            }
+            return max;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, bucket_count> m_buckets;
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<int64_t> m_sum{0};
+        std::atomic<int64_t> m_min{0};
+        std::atomic<int64_t> m_max{0};
+    }; /* class latency_histogram */
+
+} /* namespace bnb::oep::profiling */
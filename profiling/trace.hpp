@@ -0,0 +1,227 @@
+#pragma once
+
+#include <profiling/clock.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Recording of the begin/end events of the pipeline in the Chrome trace format, the written file can be
+ * opened in chrome://tracing or https://ui.perfetto.dev
+ *
+ * The events are only recorded if the module is built with the option USE_BNB_OEP_TRACING,
+ * otherwise BNB_OEP_TRACE_SCOPE() expands to nothing and costs nothing.
+ *
+ * @example
+ * bnb::oep::profiling::trace_recorder::instance().start();
+ * ... process frames ...
+ * bnb::oep::profiling::trace_recorder::instance().stop();
+ * bnb::oep::profiling::trace_recorder::instance().write_chrome_trace("oep_trace.json");
+ */
+
+namespace bnb::oep::profiling
+{
+
+    class trace_recorder
+    {
+    public:
+        /* maximum number of the events recorded by one thread between start() and stop(), the rest are dropped */
+        static constexpr size_t max_events_per_thread = 1 << 16;
+
+    public:
+        static trace_recorder& instance()
+        {
+            static trace_recorder recorder;
+            return recorder;
+        }
+
+        /* Clear the previously recorded events and start recording. May be called while the other threads are
+         * recording: the buffers are written only by their threads, so each thread clears its buffer by itself
+         * on its first event of the new generation, and the buffers of the previous generation are not written out */
+        void start()
+        {
+            m_generation.fetch_add(1, std::memory_order_acq_rel);
+            m_recording.store(true, std::memory_order_release);
+        }
+
+        void stop()
+        {
+            m_recording.store(false, std::memory_order_release);
+        }
+
+        bool is_recording() const
+        {
+            return m_recording.load(std::memory_order_relaxed);
+        }
+
+        /* name the calling thread in the trace */
+        void set_thread_name(const char* name)
+        {
+            local_buffer().name.store(name, std::memory_order_release);
+        }
+
+        /* Record the event of the calling thread, lock free except for the first event of the thread.
+         * The name and the category must be string literals, only the pointers are stored */
+        void add_event(const char* category, const char* name, int64_t begin_ns, int64_t end_ns)
+        {
+            if (!is_recording()) {
+                return;
+            }
+            auto& buffer = local_buffer();
+            auto generation = m_generation.load(std::memory_order_acquire);
+            if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+                buffer.size.store(0, std::memory_order_relaxed);
+                buffer.dropped.store(0, std::memory_order_relaxed);
+                /* the reader sees the cleared buffer together with the generation */
+                buffer.generation.store(generation, std::memory_order_release);
+            }
+            auto size = buffer.size.load(std::memory_order_relaxed);
+            if (size >= max_events_per_thread) {
+                buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer.events[size] = {category, name, begin_ns, end_ns};
+            buffer.size.store(size + 1, std::memory_order_release);
+        }
+
+        /* write the recorded events as Chrome trace JSON, should be called after stop() */
+        bool write_chrome_trace(const std::string& path)
+        {
+            std::ofstream file(path, std::ios::out | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+            uint64_t dropped = 0;
+            auto generation = m_generation.load(std::memory_order_acquire);
+            for (auto& buffer : m_buffers) {
+                if (auto name = buffer->name.load(std::memory_order_acquire)) {
+                    file << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+                         << ",\"args\":{\"name\":\"" << name << "\"}}";
+                    first = false;
+                }
+                /* the thread has not recorded since the last start(), its events are of the previous recording */
+                if (buffer->generation.load(std::memory_order_acquire) != generation) {
+                    continue;
+                }
+                auto size = buffer->size.load(std::memory_order_acquire);
+                for (size_t i = 0; i < size; ++i) {
+                    auto& e = buffer->events[i];
+                    file << (first ? "" : ",") << "\n{\"ph\":\"X\",\"cat\":\"" << e.category << "\",\"name\":\"" << e.name
+                         << "\",\"pid\":1,\"tid\":" << buffer->tid
+                         << ",\"ts\":" << to_microseconds(e.begin_ns)
+                         << ",\"dur\":" << to_microseconds(e.end_ns - e.begin_ns) << "}";
+                    first = false;
+                }
+                dropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+            file << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+            return file.good();
+        }
+
+    private:
+        struct event
+        {
+            const char* category{nullptr};
+            const char* name{nullptr};
+            int64_t begin_ns{0};
+            int64_t end_ns{0};
+        }; /* struct event */
+
+        struct thread_buffer
+        {
+            std::unique_ptr<event[]> events;
+            std::atomic<size_t> size{0};
+            std::atomic<uint64_t> dropped{0};
+            /* generation of the recording the events belong to, see start() */
+            std::atomic<uint32_t> generation{0};
+            uint32_t tid{0};
+            std::atomic<const char*> name{nullptr};
+        }; /* struct thread_buffer */
+
+        trace_recorder() = default;
+
+        /* the buffers are owned by the recorder and outlive the threads, so the events of the finished threads are kept */
+        thread_buffer& local_buffer()
+        {
+            thread_local thread_buffer* buffer = nullptr;
+            if (buffer == nullptr) {
+                auto created = std::make_unique<thread_buffer>();
+                created->events = std::make_unique<event[]>(max_events_per_thread);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                created->tid = static_cast<uint32_t>(m_buffers.size() + 1);
+                buffer = created.get();
+                m_buffers.push_back(std::move(created));
+            }
+            return *buffer;
+        }
+
+        static std::string to_microseconds(int64_t ns)
+        {
+            /* keeps the nanosecond precision without the floating point formatting */
+            auto us = ns / 1000;
+            auto fraction = ns % 1000;
+            if (fraction < 0) {
+                fraction = -fraction;
+            }
+            std::string result = std::to_string(us) + ".";
+            result += static_cast<char>('0' + fraction / 100);
+            result += static_cast<char>('0' + fraction / 10 % 10);
+            result += static_cast<char>('0' + fraction % 10);
+            return result;
+        }
+
+    private:
+        std::atomic_bool m_recording{false};
+        /* incremented by each start() */
+        std::atomic<uint32_t> m_generation{0};
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<thread_buffer>> m_buffers;
+    }; /* class trace_recorder */
+
+    /* records the event from the construction to the destruction of the scope object */
+    class trace_scope
+    {
+    public:
+        trace_scope(const char* category, const char* name)
+            : m_category(category)
+            , m_name(name)
+            , m_begin_ns(trace_recorder::instance().is_recording() ? now_ns() : 0)
+        {
+        }
+
+        ~trace_scope()
+        {
+            if (m_begin_ns != 0) {
+                trace_recorder::instance().add_event(m_category, m_name, m_begin_ns, now_ns());
+            }
+        }
+
+        trace_scope(const trace_scope&) = delete;
+        trace_scope& operator=(const trace_scope&) = delete;
+
+    private:
+        const char* m_category;
+        const char* m_name;
+        int64_t m_begin_ns;
+    }; /* class trace_scope */
+
+} /* namespace bnb::oep::profiling */
+
+#define BNB_OEP_TRACE_CONCAT_IMPL(a, b) a##b
+#define BNB_OEP_TRACE_CONCAT(a, b) BNB_OEP_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(BNB_OEP_TRACING)
+    /* record the event lasting until the end of the current scope, the arguments must be string literals */
+    #define BNB_OEP_TRACE_SCOPE(category, name) bnb::oep::profiling::trace_scope BNB_OEP_TRACE_CONCAT(bnb_oep_trace_scope_, __LINE__)(category, name)
+    #define BNB_OEP_TRACE_THREAD_NAME(name) bnb::oep::profiling::trace_recorder::instance().set_thread_name(name)
+#else
+    #define BNB_OEP_TRACE_SCOPE(category, name) ((void) 0)
+    #define BNB_OEP_TRACE_THREAD_NAME(name) ((void) 0)
+#endif /* defined(BNB_OEP_TRACING) */